@@ -28,6 +28,28 @@
  * reference. Otherwise, nodes and edges point to their own copies of their list. */
 #define LIST_HASHING
 
+/* If defined, the node and edge fields tested by the candidate filters of the
+ * matching code (mark, root flag, match stamp, degrees) are stored in packed
+ * arrays parallel to the graph's node and edge arrays. Otherwise they are stored
+ * in the Node and Edge structures. Either way, they are accessed through the
+ * macros in graph.h. */
+#define HOT_COLD_SPLIT
+
+/* If defined, each graph maintains a hash index of its edges keyed by their
+ * (source, target) pair, used to find the edges between two given nodes. 
+ * Otherwise these are found by scanning the shorter of the source's outgoing
+ * edges and the target's incoming edges. */
+#define EDGE_INDEX
+
+/* If defined, host lists and interned strings are allocated from the size-class
+ * pools of pool.c instead of directly with malloc. */
+#define POOL_ALLOCATION
+
+/* Host labels whose list consists of at most this many integers are stored in
+ * the label itself instead of in a HostList. The compiler has its own copy of
+ * this value in src/common.h, and the two must agree. */
+#define INLINE_LABEL_LENGTH 2
+
 #define print_to_log(error_message, ...)                    \
   do { fprintf(log_file, error_message, ##__VA_ARGS__); }   \
   while(0)
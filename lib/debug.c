@@ -54,14 +54,26 @@ void closeTraceFile(void)
  *     then i is in the holes array.
  * (2) The number of non-dummy nodes in the node array is equal to 
  *     graph->number_of_nodes.
- * (3) The number of edge indices >= 0 stored by a node is equal to its outdegree.
- * (4) The number of edge indices >= 0 stored by a node is equal to its indegree.
+ * (3) The number of outgoing edges stored by a node is equal to its outdegree.
+ * (4) The number of incoming edges stored by a node is equal to its indegree,
+ *     and the node stores no other edge indices.
  * (5) For 0 <= i <= graph->edges.size, if graph->edges.items[i].index is -1,
  *     then i is in the holes array.
  * (6) The number of non-dummy edges in the edge array is equal to 
  *     graph->number_of_edges.
  * (7) Source and target consistency: For all edges E, if S is E's source and
- *     T is E's target, then E is in S's outedge list and E is in T's inedge list. 
+ *     T is E's target, then E is at its recorded position in S's outedge list
+ *     and in T's inedge list. 
+ * (8) Label class table consistency: For all nodes N, N's index is stored at
+ *     position N->table_index of the label class table for N's mark and label
+ *     class.
+ * (9) The same holds for all edges and the edge label class tables.
+ * (10) Root node consistency: For all nodes N, N is a root node if and only if
+ *      N's index is stored at position N->root_index of the root node array.
+ * (11) The mark accessed by nodeMark (edgeMark) is equal to the mark of the
+ *      node's (edge's) label.
+ * (12) Every edge is found among the edges between its source and target by
+ *      firstEdgeBetween and nextEdgeBetween.
  */
 
 bool validGraph(Graph *graph)
@@ -104,38 +116,69 @@ bool validGraph(Graph *graph)
       {
          /* Keep a count of the number of nodes in the array. */
          node_count++;
-         int n;
-         for(n = 0; n < node->out_edges.size + 2; n++)
+         int indegree = nodeIndegree(graph, node->index);
+         int outdegree = nodeOutdegree(graph, node->index);
+         int n, *out_edges = getOutEdges(graph, node), *in_edges = getInEdges(graph, node);
+         for(n = 0; n < outdegree && n + indegree < node->edges.size; n++)
          {
-            Edge *node_edge = getNthOutEdge(graph, node, n);
-            /* Keep a count of the number of outedges in the array. */
-            if(node_edge != NULL) edge_count++;           
+            Edge *node_edge = getEdge(graph, out_edges[n]);
+            /* Keep a count of the number of valid outedges in the array. */
+            if(node_edge != NULL && node_edge->source == node->index) edge_count++;           
          }
          /* Invariant (3) */
-         if(node->outdegree != edge_count)
+         if(outdegree != edge_count)
          {
             fprintf(stderr, "(3) Node %d's outdegree (%d) is not equal to the "
                     "number of edges in its outedges array (%d).\n",
-                    node->index, node->outdegree, edge_count);
+                    node->index, outdegree, edge_count);
             valid_graph = false;
          }
          edge_count = 0;
 
-         for(n = 0; n < node->in_edges.size + 2; n++)
+         for(n = 0; n < indegree && n < node->edges.size; n++)
          {
-            Edge *node_edge = getNthInEdge(graph, node, n);
-            /* Keep a count of the number of inedges in the array. */
-            if(node_edge != NULL) edge_count++;
+            Edge *node_edge = getEdge(graph, in_edges[n]);
+            /* Keep a count of the number of valid inedges in the array. */
+            if(node_edge != NULL && node_edge->target == node->index) edge_count++;
          }
          /* Invariant (4) */
-         if(node->indegree != edge_count)
+         if(indegree != edge_count || node->edges.size != indegree + outdegree)
          {
             fprintf(stderr, "(4) Node %d's indegree (%d) is not equal to the number "
                     "of edges in its inedges array (%d).\n", node->index, 
-                    node->indegree, edge_count);
+                    indegree, edge_count);
             valid_graph = false;
          } 
          edge_count = 0;
+
+         /* Invariant (8) */
+         IntArray *table = getNodeTable(graph, node->label.mark, getLabelClass(node->label));
+         if(node->table_index < 0 || node->table_index >= table->size ||
+            table->items[node->table_index] != node->index)
+         {
+            fprintf(stderr, "(8) Node %d is not at position %d of its label class "
+                    "table.\n", node->index, node->table_index);
+            valid_graph = false;
+         }
+
+         /* Invariant (10) */
+         bool root_found = node->root_index >= 0 && 
+                           node->root_index < graph->root_nodes.size &&
+                           graph->root_nodes.items[node->root_index] == node->index;
+         if(nodeRoot(graph, node->index) != root_found)
+         {
+            fprintf(stderr, "(10) Node %d's root flag is inconsistent with the root "
+                    "node array.\n", node->index);
+            valid_graph = false;
+         }
+
+         /* Invariant (11) */
+         if(nodeMark(graph, node->index) != node->label.mark)
+         {
+            fprintf(stderr, "(11) Node %d's stored mark is not the mark of its "
+                    "label.\n", node->index);
+            valid_graph = false;
+         }
       }
    }
    /* Invariant (2) */
@@ -174,24 +217,28 @@ bool validGraph(Graph *graph)
       {
          /* Keep a count of the number of edges in the array. */
          edge_count++;
+         /* Invariant (9) */
+         IntArray *table = getEdgeTable(graph, edge->label.mark, getLabelClass(edge->label));
+         if(edge->table_index < 0 || edge->table_index >= table->size ||
+            table->items[edge->table_index] != edge->index)
+         {
+            fprintf(stderr, "(9) Edge %d is not at position %d of its label class "
+                    "table.\n", edge->index, edge->table_index);
+            valid_graph = false;
+         }
+         /* Invariant (11) */
+         if(edgeMark(graph, edge->index) != edge->label.mark)
+         {
+            fprintf(stderr, "(11) Edge %d's stored mark is not the mark of its "
+                    "label.\n", edge->index);
+            valid_graph = false;
+         }
          Node *source = getNode(graph, edge->source); 
          Node *target = getNode(graph, edge->target);
 
-         bool source_found = false;
-         if(source->first_out_edge == edge->index || source->second_out_edge == edge->index)
-            source_found = true;
-         if(!source_found)
-         {
-            int counter;
-            for(counter = 0; counter < source->out_edges.size; counter++)
-            {
-               if(source->out_edges.items[counter] == edge->index)
-               {
-                  source_found = true;
-                  break;
-               }
-            }
-         }
+         bool source_found = edge->out_position >= nodeIndegree(graph, source->index) &&
+                             edge->out_position < source->edges.size &&
+                             source->edges.items[edge->out_position] == edge->index;
          /* Invariant (7) */
          if(!source_found)
          {
@@ -200,21 +247,9 @@ bool validGraph(Graph *graph)
             valid_graph = false;
          }   
 
-         bool target_found = false;
-         if(target->first_in_edge == edge->index || target->second_in_edge == edge->index)
-            target_found = true;
-         if(!target_found)
-         {
-            int counter;
-            for(counter = 0; counter < target->in_edges.size; counter++)
-            {
-               if(target->in_edges.items[counter] == edge->index)
-               {
-                  target_found = true;
-                  break;
-               }
-            }
-         }
+         bool target_found = edge->in_position >= 0 &&
+                             edge->in_position < nodeIndegree(graph, target->index) &&
+                             target->edges.items[edge->in_position] == edge->index;
          if(!target_found)
          {
             fprintf(stderr, "(7) Edge %d does not occur in node %d's inedge "
@@ -222,7 +257,15 @@ bool validGraph(Graph *graph)
             valid_graph = false;
          }   
 
-
+         /* Invariant (12) */
+         int index = firstEdgeBetween(graph, edge->source, edge->target);
+         while(index >= 0 && index != edge->index) index = nextEdgeBetween(graph, index);
+         if(index < 0)
+         {
+            fprintf(stderr, "(12) Edge %d is not found among the edges from node %d "
+                    "to node %d.\n", edge->index, edge->source, edge->target);
+            valid_graph = false;
+         }
       }
    }
    /* Invariant (6) */
@@ -245,15 +288,13 @@ void printVerboseGraph(Graph *graph, FILE *file)
     for(index = 0; index < graph->nodes.size; index++)
     {
        Node *node = getNode(graph, index);
-       if(node->index >= 0) printVerboseNode(node, file);
+       if(node->index >= 0) printVerboseNode(graph, node, file);
     }   
     PTF("Root Node List: ");
-    RootNodes *iterator = graph->root_nodes;
-    while(iterator != NULL)
+    for(index = 0; index < graph->root_nodes.size; index++)
     {
-       if(iterator->next == NULL) PTF("%d\n", iterator->index);
-       else PTF("%d, ", iterator->index);
-       iterator = iterator->next;
+       if(index == graph->root_nodes.size - 1) PTF("%d\n", graph->root_nodes.items[index]);
+       else PTF("%d, ", graph->root_nodes.items[index]);
     }
     PTF("\n");
     PTF("Edges\n=====\n");
@@ -265,34 +306,24 @@ void printVerboseGraph(Graph *graph, FILE *file)
     PTF("\n");
 }
 
-void printVerboseNode(Node *node, FILE *file)
+void printVerboseNode(Graph *graph, Node *node, FILE *file)
 {
+    int indegree = nodeIndegree(graph, node->index);
+    int outdegree = nodeOutdegree(graph, node->index);
     PTF("Index: %d", node->index);
-    if(node->root) PTF(" (Root)");
+    if(nodeRoot(graph, node->index)) PTF(" (Root)");
     PTF("\n");
     PTF("Label: ");
     printHostLabel(node->label, file);
     PTF("\n");
-    PTF("Outdegree: %d. Indegree: %d\n", node->outdegree, node->indegree);
+    PTF("Outdegree: %d. Indegree: %d\n", outdegree, indegree);
 
     PTF("Outedges: ");
-    if(node->first_out_edge >= 0) PTF("%d ", node->first_out_edge);
-    if(node->second_out_edge >= 0) PTF("%d ", node->second_out_edge);
-    int index;
-    for(index = 0; index < node->out_edges.size; index++)
-    {
-       int out_edge = node->out_edges.items[index];
-       if(out_edge >= 0) PTF("%d ", out_edge);
-    }
+    int index, *out_edges = getOutEdges(graph, node), *in_edges = getInEdges(graph, node);
+    for(index = 0; index < outdegree; index++) PTF("%d ", out_edges[index]);
 
     PTF("\nInedges: ");
-    if(node->first_in_edge >= 0) PTF("%d ", node->first_in_edge);
-    if(node->second_in_edge >= 0) PTF("%d ", node->second_in_edge);
-    for(index = 0; index < node->in_edges.size; index++)
-    {
-       int in_edge = node->in_edges.items[index];
-       if(in_edge >= 0) PTF("%d ", in_edge);
-    }
+    for(index = 0; index < indegree; index++) PTF("%d ", in_edges[index]);
     PTF("\n\n");
 }
 
@@ -49,7 +49,7 @@ void closeTraceFile(void);
  * edges/bidegrees, but these can only occur in rule graphs. */
 bool validGraph(Graph *graph);
 void printVerboseGraph(Graph *graph, FILE *file);
-void printVerboseNode(Node *node, FILE *file);
+void printVerboseNode(Graph *graph, Node *node, FILE *file);
 void printVerboseEdge(Edge *edge, FILE *file);
 
 #endif /* INC_DEBUG_H */
@@ -15,9 +15,17 @@
 
 #include "graph.h"
 
-Node dummy_node = {-1, false, {NONE, 0, NULL}, 0, 0, -1, -1, -1, -1, 
-                   {0, 0, NULL}, {0, 0, NULL}, false};
-Edge dummy_edge = {-1, {NONE, 0, NULL}, -1, -1, false};
+#include <string.h>
+
+/* The fields not named here are false or 0. */
+Node dummy_node = {.index = -1, .label = {NONE, 0, NULL}, .edges = {0, 0, NULL},
+                   .table_index = -1, .root_index = -1};
+Edge dummy_edge = {.index = -1, .label = {NONE, 0, NULL}, .source = -1, .target = -1,
+                   .out_position = -1, .in_position = -1, .table_index = -1,
+                   #ifdef EDGE_INDEX
+                      .index_prev = -1, .index_next = -1
+                   #endif
+                  };
 
 IntArray makeIntArray(int initial_capacity)
 {
@@ -87,6 +95,44 @@ void removeFromIntArray(IntArray *array, int index)
    }
 }
    
+#ifdef HOT_COLD_SPLIT
+/* Resizes one of the hot field arrays of a node or edge array. The entries past
+ * the old capacity are set to 0. */
+static void *resizeHotArray(void *array, int old_capacity, int new_capacity, size_t size)
+{
+   array = realloc(array, new_capacity * size);
+   if(array == NULL && new_capacity > 0)
+   {
+      print_to_log("Error (resizeHotArray): malloc failure.\n");
+      exit(1);
+   }
+   if(new_capacity > old_capacity)
+      memset((char *)array + old_capacity * size, 0, (new_capacity - old_capacity) * size);
+   return array;
+}
+
+static void resizeHotNodeArrays(NodeArray *array, int old_capacity)
+{
+   array->marks = resizeHotArray(array->marks, old_capacity, array->capacity,
+                                 sizeof(unsigned char));
+   array->roots = resizeHotArray(array->roots, old_capacity, array->capacity, sizeof(bool));
+   array->match_stamps = resizeHotArray(array->match_stamps, old_capacity, 
+                                        array->capacity, sizeof(unsigned int));
+   array->indegrees = resizeHotArray(array->indegrees, old_capacity, array->capacity,
+                                     sizeof(int));
+   array->outdegrees = resizeHotArray(array->outdegrees, old_capacity, array->capacity,
+                                      sizeof(int));
+}
+
+static void resizeHotEdgeArrays(EdgeArray *array, int old_capacity)
+{
+   array->marks = resizeHotArray(array->marks, old_capacity, array->capacity,
+                                 sizeof(unsigned char));
+   array->match_stamps = resizeHotArray(array->match_stamps, old_capacity, 
+                                        array->capacity, sizeof(unsigned int));
+}
+#endif
+
 static NodeArray makeNodeArray(int initial_capacity)
 {
    NodeArray array;
@@ -98,6 +144,13 @@ static NodeArray makeNodeArray(int initial_capacity)
       print_to_log("Error (makeNodeArray): malloc failure.\n");
       exit(1);
    }
+   #ifdef HOT_COLD_SPLIT
+      array.marks = NULL;
+      array.roots = NULL;
+      array.match_stamps = NULL;
+      array.indegrees = array.outdegrees = NULL;
+      resizeHotNodeArrays(&array, 0);
+   #endif
    array.holes = makeIntArray(16);
    return array;
 }
@@ -111,6 +164,9 @@ static void doubleNodeArray(NodeArray *array)
       print_to_log("Error (doubleCapacity): malloc failure.\n");
       exit(1);
    }
+   #ifdef HOT_COLD_SPLIT
+      resizeHotNodeArrays(array, array->capacity / 2);
+   #endif
 }
 
 static int addToNodeArray(NodeArray *array, Node node)
@@ -155,6 +211,11 @@ static EdgeArray makeEdgeArray(int initial_capacity)
       print_to_log("Error (makeEdgeArray): malloc failure.\n");
       exit(1);
    }
+   #ifdef HOT_COLD_SPLIT
+      array.marks = NULL;
+      array.match_stamps = NULL;
+      resizeHotEdgeArrays(&array, 0);
+   #endif
    array.holes = makeIntArray(16);
    return array;
 }
@@ -169,6 +230,9 @@ static void doubleEdgeArray(EdgeArray *array)
       print_to_log("Error (doubleCapacity): malloc failure.\n");
       exit(1);
    }
+   #ifdef HOT_COLD_SPLIT
+      resizeHotEdgeArrays(array, array->capacity / 2);
+   #endif
 }
 
 static int addToEdgeArray(EdgeArray *array, Edge edge)
@@ -205,6 +269,39 @@ static void removeFromEdgeArray(EdgeArray *array, int index)
 }
 
 
+LabelClass getLabelClass(HostLabel label)
+{
+   switch(label.length)
+   {
+      case 0: return EMPTY_L;
+      case 1: 
+           if(label.list == NULL) return INT_L;
+           return label.list->atoms[0].type == 'i' ? INT_L : STRING_L;
+      case 2: return LIST2_L;
+      case 3: return LIST3_L;
+      case 4: return LIST4_L;
+      default: return LONG_LIST_L;
+   }
+}
+
+#ifdef EDGE_INDEX
+static void makeEdgeIndex(EdgeIndex *edge_index, int edges)
+{
+   edge_index->capacity = 16;
+   while(edge_index->capacity < edges) edge_index->capacity *= 2;
+   edge_index->size = 0;
+   edge_index->buckets = malloc(edge_index->capacity * sizeof(int));
+   if(edge_index->buckets == NULL)
+   {
+      print_to_log("Error (makeEdgeIndex): malloc failure.\n");
+      exit(1);
+   }
+   int bucket;
+   for(bucket = 0; bucket < edge_index->capacity; bucket++) 
+      edge_index->buckets[bucket] = -1;
+}
+#endif
+
 /* ===============
  * Graph Functions
  * =============== */
@@ -221,67 +318,77 @@ Graph *newGraph(int nodes, int edges)
 
    graph->number_of_nodes = 0;
    graph->number_of_edges = 0;
-   graph->root_nodes = NULL;
+   graph->root_nodes = makeIntArray(0);
+   graph->match_epoch = 1;
+   #ifdef EDGE_INDEX
+      makeEdgeIndex(&(graph->edge_index), edges);
+   #endif
+   graph->node_frontier = makeIntArray(FRONTIER_SIZE);
+   graph->edge_frontier = makeIntArray(FRONTIER_SIZE);
+   graph->root_epoch = 0;
+
+   int mark, label_class;
+   for(mark = 0; mark < NUMBER_OF_MARKS; mark++)
+      for(label_class = 0; label_class < NUMBER_OF_CLASSES; label_class++)
+      {
+         graph->node_tables[mark][label_class] = makeIntArray(0);
+         graph->edge_tables[mark][label_class] = makeIntArray(0);
+         graph->node_epochs[mark][label_class] = 0;
+         graph->edge_epochs[mark][label_class] = 0;
+      }
    return graph;
 }
 
+/* The clock is shared by all graphs, so that the epochs of a graph copy differ
+ * from those of the graph it was copied from. It is 64 bits wide so that it
+ * does not wrap around. */
+static unsigned long long modification_clock = 0;
+
+/* Further items are not recorded once the frontier is full. */
+static void addToFrontier(IntArray *frontier, int index)
+{
+   if(frontier->size < FRONTIER_SIZE) frontier->items[frontier->size++] = index;
+}
+
 int addNode(Graph *graph, bool root, HostLabel label) 
 {
-   Node node;
-   node.root = root;
+   Node node = dummy_node;
    node.label = label;
-   node.first_out_edge = -1;
-   node.second_out_edge = -1;
-   node.first_in_edge = -1;
-   node.second_in_edge = -1;
-   node.out_edges = makeIntArray(0);
-   node.in_edges = makeIntArray(0);
-   node.outdegree = 0;
-   node.indegree = 0;
-   node.matched = false;
+   node.edges = makeIntArray(0);
 
    int index = addToNodeArray(&(graph->nodes), node);
+   addToNodeTable(graph, index);
    if(root) addRootNode(graph, index);
+   addToFrontier(&(graph->node_frontier), index);
    graph->number_of_nodes++;
    return index; 
 }
 
 void addRootNode(Graph *graph, int index)
 {
-   RootNodes *root_node = malloc(sizeof(RootNodes));
-   if(root_node == NULL)
-   {
-      print_to_log("Error (addRootNode): malloc failure.\n");
-      exit(1);
-   }
-   root_node->index = index;
-   root_node->next = graph->root_nodes;
-   graph->root_nodes = root_node;
+   Node *node = getNode(graph, index);
+   node->root_index = graph->root_nodes.size;
+   addToIntArray(&(graph->root_nodes), index);
+   nodeRoot(graph, index) = true;
+   graph->root_epoch = ++modification_clock;
 }
 
 int addEdge(Graph *graph, HostLabel label, int source_index, int target_index) 
 {
-   Edge edge;
+   Edge edge = dummy_edge;
    edge.label = label;
    edge.source = source_index;
    edge.target = target_index;
-   edge.matched = false;
 
    int index = addToEdgeArray(&(graph->edges), edge);
+   addToEdgeTable(graph, index);
 
-   Node *source = getNode(graph, source_index);
-   assert(source != NULL);
-   if(source->first_out_edge == -1) source->first_out_edge = index;
-   else if(source->second_out_edge == -1) source->second_out_edge = index;
-   else addToIntArray(&(source->out_edges), index);
-   source->outdegree++;
-
-   Node *target = getNode(graph, target_index);
-   assert(target != NULL);
-   if(target->first_in_edge == -1) target->first_in_edge = index;
-   else if(target->second_in_edge == -1) target->second_in_edge = index;
-   else addToIntArray(&(target->in_edges), index);
-   target->indegree++;
+   assert(getNode(graph, source_index) != NULL);
+   assert(getNode(graph, target_index) != NULL);
+   insertIncidentEdge(graph, index, -1, nodeIndegree(graph, target_index));
+   addToFrontier(&(graph->edge_frontier), index);
+   addToFrontier(&(graph->node_frontier), source_index);
+   addToFrontier(&(graph->node_frontier), target_index);
 
    graph->number_of_edges++;
    return index; 
@@ -290,49 +397,41 @@ int addEdge(Graph *graph, HostLabel label, int source_index, int target_index)
 void removeNode(Graph *graph, int index)
 {   
    Node *node = getNode(graph, index);  
-   assert(node->indegree == 0 && node->outdegree == 0);
-   if(node->out_edges.items != NULL) free(node->out_edges.items);
-   if(node->in_edges.items != NULL) free(node->in_edges.items); 
-   if(node->root) removeRootNode(graph, index);
+   assert(nodeIndegree(graph, index) == 0 && nodeOutdegree(graph, index) == 0);
+   if(node->edges.items != NULL) free(node->edges.items);
+   if(nodeRoot(graph, index)) removeRootNode(graph, index);
+   removeFromNodeTable(graph, index);
 
    removeHostList(node->label.list);
+   setNodeMatched(graph, index, false);
    
    removeFromNodeArray(&(graph->nodes), index);
    graph->number_of_nodes--;
 }
 
+/* The last entry of the root node array is moved into the removed node's 
+ * position. */
 void removeRootNode(Graph *graph, int index)
 {
-   RootNodes *current = graph->root_nodes, *previous = NULL;
-   while(current != NULL)
-   {
-      if(current->index == index) 
-      {
-         if(previous == NULL) graph->root_nodes = current->next;
-         else previous->next = current->next;
-         free(current);
-         break;
-      }
-      previous = current;
-      current = current->next;
-   }
+   Node *node = getNode(graph, index);
+   IntArray *root_nodes = &(graph->root_nodes);
+   int last = root_nodes->items[--root_nodes->size];
+   root_nodes->items[node->root_index] = last;
+   graph->nodes.items[last].root_index = node->root_index;
+   root_nodes->items[root_nodes->size] = -1;
+   node->root_index = -1;
+   nodeRoot(graph, index) = false;
+   graph->root_epoch = ++modification_clock;
 }
 
 void removeEdge(Graph *graph, int index) 
 {
-   Node *source = getNode(graph, graph->edges.items[index].source);
-   if(source->first_out_edge == index) source->first_out_edge = -1;
-   else if(source->second_out_edge == index) source->second_out_edge = -1;
-   else removeFromIntArray(&(source->out_edges), index);
-   source->outdegree--;
-
-   Node *target = getNode(graph, graph->edges.items[index].target);
-   if(target->first_in_edge == index) target->first_in_edge = -1;
-   else if(target->second_in_edge == index) target->second_in_edge = -1;
-   else removeFromIntArray(&(target->in_edges), index);
-   target->indegree--;
-
+   addToFrontier(&(graph->node_frontier), graph->edges.items[index].source);
+   addToFrontier(&(graph->node_frontier), graph->edges.items[index].target);
+   removeIncidentEdge(graph, index);
+   removeFromEdgeTable(graph, index);
    removeHostList(graph->edges.items[index].label.list);
+   setEdgeMatched(graph, index, false);
 
    removeFromEdgeArray(&(graph->edges), index);
    graph->number_of_edges--;
@@ -340,42 +439,467 @@ void removeEdge(Graph *graph, int index)
 
 void relabelNode(Graph *graph, int index, HostLabel new_label) 
 {
+   removeFromNodeTable(graph, index);
    removeHostList(graph->nodes.items[index].label.list);
    graph->nodes.items[index].label = new_label;
+   addToNodeTable(graph, index);
+   addToFrontier(&(graph->node_frontier), index);
 }
 
 void changeNodeMark(Graph *graph, int index, MarkType new_mark)
 {
+   removeFromNodeTable(graph, index);
    graph->nodes.items[index].label.mark = new_mark;
+   addToNodeTable(graph, index);
+   addToFrontier(&(graph->node_frontier), index);
 }
 
 void changeRoot(Graph *graph, int index)
 {
-   bool is_root = graph->nodes.items[index].root;
-   if(is_root) removeRootNode(graph, index);
+   if(nodeRoot(graph, index)) removeRootNode(graph, index);
    else addRootNode(graph, index);
-   graph->nodes.items[index].root = !is_root;
-}
-
-void resetMatchedNodeFlag(Graph *graph, int index)
-{
-   graph->nodes.items[index].matched = false;
+   addToFrontier(&(graph->node_frontier), index);
 }
 
 void relabelEdge(Graph *graph, int index, HostLabel new_label)
 {	
+   removeFromEdgeTable(graph, index);
    removeHostList(graph->edges.items[index].label.list);
    graph->edges.items[index].label = new_label;
+   addToEdgeTable(graph, index);
+   addToFrontier(&(graph->edge_frontier), index);
 }
 
 void changeEdgeMark(Graph *graph, int index, MarkType new_mark)
 {
+   removeFromEdgeTable(graph, index);
    graph->edges.items[index].label.mark = new_mark;
+   addToEdgeTable(graph, index);
+   addToFrontier(&(graph->edge_frontier), index);
+}
+
+/* When the epoch wraps around, the stamps are cleared so that no stale stamp
+ * matches a future epoch. */
+void resetMatchedFlags(Graph *graph)
+{
+   if(++graph->match_epoch != 0) return;
+   int index;
+   for(index = 0; index < graph->nodes.size; index++) setNodeMatched(graph, index, false);
+   for(index = 0; index < graph->edges.size; index++) setEdgeMatched(graph, index, false);
+   graph->match_epoch = 1;
+}
+
+void clearFrontier(Graph *graph)
+{
+   graph->node_frontier.size = 0;
+   graph->edge_frontier.size = 0;
+}
+
+#ifdef EDGE_INDEX
+static int hashEdgeEnds(int source, int target, int capacity)
+{
+   unsigned int hash = (unsigned int)source * 2654435761u + (unsigned int)target * 40503u;
+   hash ^= hash >> 16;
+   return hash & (capacity - 1);
+}
+
+static void linkIntoBucket(Graph *graph, Edge *edge, int *buckets, int capacity)
+{
+   int bucket = hashEdgeEnds(edge->source, edge->target, capacity);
+   edge->index_prev = -1;
+   edge->index_next = buckets[bucket];
+   if(buckets[bucket] >= 0) graph->edges.items[buckets[bucket]].index_prev = edge->index;
+   buckets[bucket] = edge->index;
+}
+
+/* Moves the edges into a bucket array of twice the size by walking the chains,
+ * since the edge array may contain edges that are not yet indexed (copyGraph). */
+static void growEdgeIndex(Graph *graph)
+{
+   EdgeIndex *edge_index = &(graph->edge_index);
+   int capacity = 2 * edge_index->capacity, bucket;
+   int *buckets = malloc(capacity * sizeof(int));
+   if(buckets == NULL)
+   {
+      print_to_log("Error (growEdgeIndex): malloc failure.\n");
+      exit(1);
+   }
+   for(bucket = 0; bucket < capacity; bucket++) buckets[bucket] = -1;
+   for(bucket = 0; bucket < edge_index->capacity; bucket++)
+   {
+      int index = edge_index->buckets[bucket];
+      while(index >= 0)
+      {
+         Edge *edge = &(graph->edges.items[index]);
+         index = edge->index_next;
+         linkIntoBucket(graph, edge, buckets, capacity);
+      }
+   }
+   free(edge_index->buckets);
+   edge_index->buckets = buckets;
+   edge_index->capacity = capacity;
+}
+
+void addToEdgeIndex(Graph *graph, int index)
+{
+   EdgeIndex *edge_index = &(graph->edge_index);
+   linkIntoBucket(graph, &(graph->edges.items[index]), edge_index->buckets, 
+                  edge_index->capacity);
+   if(++edge_index->size > edge_index->capacity) growEdgeIndex(graph);
+}
+
+static void removeFromEdgeIndex(Graph *graph, int index)
+{
+   EdgeIndex *edge_index = &(graph->edge_index);
+   Edge *edge = &(graph->edges.items[index]);
+   if(edge->index_prev >= 0) 
+      graph->edges.items[edge->index_prev].index_next = edge->index_next;
+   else 
+   {
+      int bucket = hashEdgeEnds(edge->source, edge->target, edge_index->capacity);
+      edge_index->buckets[bucket] = edge->index_next;
+   }
+   if(edge->index_next >= 0) 
+      graph->edges.items[edge->index_next].index_prev = edge->index_prev;
+   edge->index_prev = -1;
+   edge->index_next = -1;
+   edge_index->size--;
+}
+
+/* Reindexes every edge. Called when the edges have been renumbered. */
+static void rebuildEdgeIndex(Graph *graph)
+{
+   EdgeIndex *edge_index = &(graph->edge_index);
+   int index;
+   for(index = 0; index < edge_index->capacity; index++) edge_index->buckets[index] = -1;
+   for(index = 0; index < graph->edges.size; index++)
+   {
+      Edge *edge = &(graph->edges.items[index]);
+      if(edge->index < 0) continue;
+      linkIntoBucket(graph, edge, edge_index->buckets, edge_index->capacity);
+   }
+}
+#endif
+
+/* A node's incident edges are stored contiguously in its edges array: the
+ * incoming edges occupy positions 0 to indegree - 1 and the outgoing edges the
+ * following outdegree positions. An edge stores its position in the array of
+ * its source and in the array of its target. The functions below keep the
+ * array free of holes by moving at most two entries per operation, so that
+ * insertion and removal take constant time. Insertion at a position moves the
+ * entry there to the end of its range, and removal is the converse; this lets
+ * the undo code restore the exact order of the array. */
+static void moveIncidentEdge(Graph *graph, Node *node, int from, int to, bool outgoing)
+{
+   int index = node->edges.items[from];
+   node->edges.items[to] = index;
+   if(outgoing) graph->edges.items[index].out_position = to;
+   else graph->edges.items[index].in_position = to;
+}
+
+static void insertOutEdge(Graph *graph, Node *node, int index, int position)
+{
+   int indegree = nodeIndegree(graph, node->index);
+   int end = indegree + nodeOutdegree(graph, node->index);
+   assert(position >= indegree && position <= end);
+   addToIntArray(&(node->edges), -1);
+   if(position < end) moveIncidentEdge(graph, node, position, end, true);
+   node->edges.items[position] = index;
+   graph->edges.items[index].out_position = position;
+   nodeOutdegree(graph, node->index)++;
+}
+
+static void insertInEdge(Graph *graph, Node *node, int index, int position)
+{
+   int indegree = nodeIndegree(graph, node->index);
+   int outdegree = nodeOutdegree(graph, node->index);
+   int end = indegree + outdegree;
+   assert(position >= 0 && position <= indegree);
+   addToIntArray(&(node->edges), -1);
+   /* Move the first outgoing edge to the end to free the position after the
+    * incoming edges. */
+   if(outdegree > 0) moveIncidentEdge(graph, node, indegree, end, true);
+   if(position < indegree) moveIncidentEdge(graph, node, position, indegree, false);
+   node->edges.items[position] = index;
+   graph->edges.items[index].in_position = position;
+   nodeIndegree(graph, node->index)++;
+}
+
+static void removeOutEdge(Graph *graph, Node *node, int position)
+{
+   int last = nodeIndegree(graph, node->index) + nodeOutdegree(graph, node->index) - 1;
+   moveIncidentEdge(graph, node, last, position, true);
+   node->edges.items[last] = -1;
+   node->edges.size--;
+   nodeOutdegree(graph, node->index)--;
+}
+
+static void removeInEdge(Graph *graph, Node *node, int position)
+{
+   int indegree = nodeIndegree(graph, node->index);
+   int outdegree = nodeOutdegree(graph, node->index);
+   int last_in = indegree - 1, last = indegree + outdegree - 1;
+   moveIncidentEdge(graph, node, last_in, position, false);
+   /* Move the last outgoing edge into the position freed at the end of the
+    * incoming edges. */
+   if(outdegree > 0) moveIncidentEdge(graph, node, last, last_in, true);
+   node->edges.items[last] = -1;
+   node->edges.size--;
+   nodeIndegree(graph, node->index)--;
+}
+
+/* The incoming edge is inserted before the outgoing edge and removed after it.
+ * For loops, whose two positions are in the same array, this ordering keeps the
+ * recorded out_position valid when the removal is undone. */
+void insertIncidentEdge(Graph *graph, int index, int out_position, int in_position)
+{
+   Edge *edge = getEdge(graph, index);
+   Node *target = getNode(graph, edge->target);
+   insertInEdge(graph, target, index, in_position);
+   Node *source = getNode(graph, edge->source);
+   if(out_position < 0) 
+      out_position = nodeIndegree(graph, source->index) + nodeOutdegree(graph, source->index);
+   insertOutEdge(graph, source, index, out_position);
+   #ifdef EDGE_INDEX
+      addToEdgeIndex(graph, index);
+   #endif
+}
+
+void removeIncidentEdge(Graph *graph, int index)
+{
+   Edge *edge = getEdge(graph, index);
+   removeOutEdge(graph, getNode(graph, edge->source), edge->out_position);
+   removeInEdge(graph, getNode(graph, edge->target), edge->in_position);
+   #ifdef EDGE_INDEX
+      removeFromEdgeIndex(graph, index);
+   #endif
+}
+
+void addToNodeTable(Graph *graph, int index)
+{
+   Node *node = getNode(graph, index);
+   MarkType mark = node->label.mark;
+   LabelClass label_class = getLabelClass(node->label);
+   IntArray *table = getNodeTable(graph, mark, label_class);
+   node->table_index = table->size;
+   addToIntArray(table, index);
+   graph->node_epochs[mark][label_class] = ++modification_clock;
+   #ifdef HOT_COLD_SPLIT
+      graph->nodes.marks[index] = node->label.mark;
+   #endif
+}
+
+/* The last entry of the table is moved into the removed node's position so
+ * that the table stays dense. */
+void removeFromNodeTable(Graph *graph, int index)
+{
+   Node *node = getNode(graph, index);
+   MarkType mark = node->label.mark;
+   LabelClass label_class = getLabelClass(node->label);
+   IntArray *table = getNodeTable(graph, mark, label_class);
+   int last = table->items[--table->size];
+   table->items[node->table_index] = last;
+   graph->nodes.items[last].table_index = node->table_index;
+   table->items[table->size] = -1;
+   node->table_index = -1;
+   graph->node_epochs[mark][label_class] = ++modification_clock;
+}
+
+void addToEdgeTable(Graph *graph, int index)
+{
+   Edge *edge = getEdge(graph, index);
+   MarkType mark = edge->label.mark;
+   LabelClass label_class = getLabelClass(edge->label);
+   IntArray *table = getEdgeTable(graph, mark, label_class);
+   edge->table_index = table->size;
+   addToIntArray(table, index);
+   graph->edge_epochs[mark][label_class] = ++modification_clock;
+   #ifdef HOT_COLD_SPLIT
+      graph->edges.marks[index] = edge->label.mark;
+   #endif
+}
+
+void removeFromEdgeTable(Graph *graph, int index)
+{
+   Edge *edge = getEdge(graph, index);
+   MarkType mark = edge->label.mark;
+   LabelClass label_class = getLabelClass(edge->label);
+   IntArray *table = getEdgeTable(graph, mark, label_class);
+   int last = table->items[--table->size];
+   table->items[edge->table_index] = last;
+   graph->edges.items[last].table_index = edge->table_index;
+   table->items[table->size] = -1;
+   edge->table_index = -1;
+   graph->edge_epochs[mark][label_class] = ++modification_clock;
+}
+
+/* ================
+ * Graph Compaction
+ * ================ */
+/* Arrays with fewer holes than this are never compacted. */
+#define MIN_COMPACTION_HOLES 64
+
+/* Returns the capacity of a compacted array holding size items: the capacity is
+ * halved while the array would remain at most a quarter full. */
+static int compactedCapacity(int capacity, int size)
+{
+   while(capacity > 16 && capacity / 2 >= 4 * size) capacity /= 2;
+   return capacity;
+}
+
+static void clearHoles(IntArray *holes)
+{
+   int index;
+   for(index = 0; index < holes->size; index++) holes->items[index] = -1;
+   holes->size = 0;
+}
+
+/* Moves the nodes to the front of the node array in index order, recording the
+ * new index of each node in new_indices, and shrinks the array. */
+static void compactNodeArray(Graph *graph, int *new_indices)
+{
+   NodeArray *array = &(graph->nodes);
+   int index, count = 0;
+   for(index = 0; index < array->size; index++)
+   {
+      new_indices[index] = -1;
+      if(array->items[index].index < 0) continue;
+      new_indices[index] = count;
+      array->items[count] = array->items[index];
+      array->items[count].index = count;
+      #ifdef HOT_COLD_SPLIT
+         array->marks[count] = array->marks[index];
+         array->roots[count] = array->roots[index];
+         array->match_stamps[count] = array->match_stamps[index];
+         array->indegrees[count] = array->indegrees[index];
+         array->outdegrees[count] = array->outdegrees[index];
+      #endif
+      count++;
+   }
+   array->size = count;
+   clearHoles(&(array->holes));
+
+   int old_capacity = array->capacity;
+   array->capacity = compactedCapacity(array->capacity, count);
+   if(array->capacity < old_capacity)
+   {
+      array->items = realloc(array->items, array->capacity * sizeof(Node));
+      if(array->items == NULL)
+      {
+         print_to_log("Error (compactNodeArray): malloc failure.\n");
+         exit(1);
+      }
+   }
+   #ifdef HOT_COLD_SPLIT
+      resizeHotNodeArrays(array, array->capacity);
+      /* Restore the zero entries of the free slots. */
+      int unused = array->capacity - count;
+      memset(array->roots + count, 0, unused * sizeof(bool));
+      memset(array->match_stamps + count, 0, unused * sizeof(unsigned int));
+      memset(array->indegrees + count, 0, unused * sizeof(int));
+      memset(array->outdegrees + count, 0, unused * sizeof(int));
+   #endif
+}
+
+static void compactEdgeArray(Graph *graph, int *new_indices)
+{
+   EdgeArray *array = &(graph->edges);
+   int index, count = 0;
+   for(index = 0; index < array->size; index++)
+   {
+      new_indices[index] = -1;
+      if(array->items[index].index < 0) continue;
+      new_indices[index] = count;
+      array->items[count] = array->items[index];
+      array->items[count].index = count;
+      #ifdef HOT_COLD_SPLIT
+         array->marks[count] = array->marks[index];
+         array->match_stamps[count] = array->match_stamps[index];
+      #endif
+      count++;
+   }
+   array->size = count;
+   clearHoles(&(array->holes));
+
+   int old_capacity = array->capacity;
+   array->capacity = compactedCapacity(array->capacity, count);
+   if(array->capacity < old_capacity)
+   {
+      array->items = realloc(array->items, array->capacity * sizeof(Edge));
+      if(array->items == NULL)
+      {
+         print_to_log("Error (compactEdgeArray): malloc failure.\n");
+         exit(1);
+      }
+   }
+   #ifdef HOT_COLD_SPLIT
+      resizeHotEdgeArrays(array, array->capacity);
+      memset(array->match_stamps + count, 0,
+             (array->capacity - count) * sizeof(unsigned int));
+   #endif
+}
+
+static void renumberIntArray(IntArray *array, int *new_indices)
+{
+   int index;
+   for(index = 0; index < array->size; index++)
+      array->items[index] = new_indices[array->items[index]];
 }
 
-void resetMatchedEdgeFlag(Graph *graph, int index)
+/* Frontier entries may be -1 or refer to holes, which are mapped to -1. */
+static void renumberFrontier(IntArray *frontier, int *new_indices)
 {
-   graph->edges.items[index].matched = false; 
+   int index;
+   for(index = 0; index < frontier->size; index++)
+      if(frontier->items[index] >= 0) 
+         frontier->items[index] = new_indices[frontier->items[index]];
+}
+
+/* Both arrays are compacted if either has reached the threshold. Positions in
+ * the incident edge arrays, the root node array and the label class tables are
+ * unchanged by the renumbering, so the stored positions remain valid. */
+void compactGraph(Graph *graph)
+{
+   int node_holes = graph->nodes.holes.size, edge_holes = graph->edges.holes.size;
+   if(!(node_holes >= MIN_COMPACTION_HOLES && 2 * node_holes >= graph->nodes.size) &&
+      !(edge_holes >= MIN_COMPACTION_HOLES && 2 * edge_holes >= graph->edges.size))
+      return;
+
+   int *new_node_indices = malloc(graph->nodes.size * sizeof(int));
+   int *new_edge_indices = malloc(graph->edges.size * sizeof(int));
+   if((new_node_indices == NULL && graph->nodes.size > 0) ||
+      (new_edge_indices == NULL && graph->edges.size > 0))
+   {
+      print_to_log("Error (compactGraph): malloc failure.\n");
+      exit(1);
+   }
+   compactNodeArray(graph, new_node_indices);
+   compactEdgeArray(graph, new_edge_indices);
+
+   int index;
+   for(index = 0; index < graph->nodes.size; index++)
+      renumberIntArray(&(graph->nodes.items[index].edges), new_edge_indices);
+   for(index = 0; index < graph->edges.size; index++)
+   {
+      Edge *edge = getEdge(graph, index);
+      edge->source = new_node_indices[edge->source];
+      edge->target = new_node_indices[edge->target];
+   }
+   renumberIntArray(&(graph->root_nodes), new_node_indices);
+   renumberFrontier(&(graph->node_frontier), new_node_indices);
+   renumberFrontier(&(graph->edge_frontier), new_edge_indices);
+   int mark, label_class;
+   for(mark = 0; mark < NUMBER_OF_MARKS; mark++)
+      for(label_class = 0; label_class < NUMBER_OF_CLASSES; label_class++)
+      {
+         renumberIntArray(&(graph->node_tables[mark][label_class]), new_node_indices);
+         renumberIntArray(&(graph->edge_tables[mark][label_class]), new_edge_indices);
+      }
+   free(new_node_indices);
+   free(new_edge_indices);
+   #ifdef EDGE_INDEX
+      rebuildEdgeIndex(graph);
+   #endif
 }
 
 /* ========================
@@ -395,35 +919,115 @@ Edge *getEdge(Graph *graph, int index)
    else return &(graph->edges.items[index]);
 }
 
-RootNodes *getRootNodeList(Graph *graph)
+IntArray *getRootNodeList(Graph *graph)
 {
-   return graph->root_nodes;
+   return &(graph->root_nodes);
 }
 
-Edge *getNthOutEdge(Graph *graph, Node *node, int n)
+IntArray *getNodeFrontier(Graph *graph)
 {
-   assert(n >= 0);
-   if(n == 0) return getEdge(graph, node->first_out_edge);
-   else if(n == 1) return getEdge(graph, node->second_out_edge);
-   else
+   return &(graph->node_frontier);
+}
+
+IntArray *getEdgeFrontier(Graph *graph)
+{
+   return &(graph->edge_frontier);
+}
+
+IntArray *getNodeTable(Graph *graph, MarkType mark, LabelClass label_class)
+{
+   assert(mark < NUMBER_OF_MARKS && label_class < NUMBER_OF_CLASSES);
+   return &(graph->node_tables[mark][label_class]);
+}
+
+IntArray *getEdgeTable(Graph *graph, MarkType mark, LabelClass label_class)
+{
+   assert(mark < NUMBER_OF_MARKS && label_class < NUMBER_OF_CLASSES);
+   return &(graph->edge_tables[mark][label_class]);
+}
+
+int *getInEdges(Graph *graph, Node *node)
+{
+   return node->edges.items;
+}
+
+int *getOutEdges(Graph *graph, Node *node)
+{
+   /* Note that this may point one past the last incoming edge if the node
+    * has no outgoing edges. */
+   return node->edges.items + nodeIndegree(graph, node->index);
+}
+
+int *getIncidentEdges(Graph *graph, Node *node)
+{
+   return node->edges.items;
+}
+
+#ifdef EDGE_INDEX
+/* Returns the first edge from source to target in the bucket chain starting
+ * with the passed index. */
+static int findInBucket(Graph *graph, int index, int source, int target)
+{
+   while(index >= 0)
    {
-      assert(n - 2 < node->out_edges.size);
-      return getEdge(graph, node->out_edges.items[n - 2]);
+      Edge *edge = &(graph->edges.items[index]);
+      if(edge->source == source && edge->target == target) return index;
+      index = edge->index_next;
    }
+   return -1;
 }
 
-Edge *getNthInEdge(Graph *graph, Node *node, int n)
+int firstEdgeBetween(Graph *graph, int source, int target)
 {
-   assert(n >= 0);
-   if(n == 0) return getEdge(graph, node->first_in_edge);
-   else if(n == 1) return getEdge(graph, node->second_in_edge);
+   int bucket = hashEdgeEnds(source, target, graph->edge_index.capacity);
+   return findInBucket(graph, graph->edge_index.buckets[bucket], source, target);
+}
+
+int nextEdgeBetween(Graph *graph, int index)
+{
+   Edge *edge = &(graph->edges.items[index]);
+   return findInBucket(graph, edge->index_next, edge->source, edge->target);
+}
+#else
+/* Scans the shorter of the source's outgoing edges and the target's incoming
+ * edges, starting after the passed edge or from the beginning if it is NULL.
+ * The degrees are fixed during an iteration, so every call scans the same range. */
+static int scanEdgesBetween(Graph *graph, int source, int target, Edge *previous)
+{
+   int position, end;
+   Node *node;
+   if(nodeOutdegree(graph, source) <= nodeIndegree(graph, target))
+   {
+      node = getNode(graph, source);
+      position = previous == NULL ? nodeIndegree(graph, source) : previous->out_position + 1;
+      end = nodeIndegree(graph, source) + nodeOutdegree(graph, source);
+   }
    else
    {
-      assert(n - 2 < node->in_edges.size);
-      return getEdge(graph, node->in_edges.items[n - 2]);
+      node = getNode(graph, target);
+      position = previous == NULL ? 0 : previous->in_position + 1;
+      end = nodeIndegree(graph, target);
    }
+   for(; position < end; position++)
+   {
+      Edge *edge = getEdge(graph, node->edges.items[position]);
+      if(edge->source == source && edge->target == target) return edge->index;
+   }
+   return -1;
 }
 
+int firstEdgeBetween(Graph *graph, int source, int target)
+{
+   return scanEdgesBetween(graph, source, target, NULL);
+}
+
+int nextEdgeBetween(Graph *graph, int index)
+{
+   Edge *edge = getEdge(graph, index);
+   return scanEdgesBetween(graph, edge->source, edge->target, edge);
+}
+#endif
+
 Node *getSource(Graph *graph, Edge *edge) 
 {
    return getNode(graph, edge->source);
@@ -448,14 +1052,14 @@ HostLabel getEdgeLabel(Graph *graph, int index)
 
 int getIndegree(Graph *graph, int index) 
 {
-   Node *node = getNode(graph, index);
-   return node->indegree;
+   assert(getNode(graph, index) != NULL);
+   return nodeIndegree(graph, index);
 }
 
 int getOutdegree(Graph *graph, int index) 
 {
-   Node *node = getNode(graph, index);
-   return node->outdegree;
+   assert(getNode(graph, index) != NULL);
+   return nodeOutdegree(graph, index);
 }
 
 void printGraph(Graph *graph, FILE *file) 
@@ -484,7 +1088,7 @@ void printGraph(Graph *graph, FILE *file)
       /* Five nodes per line */
       if(node_count != 0 && node_count % 5 == 0) PTF("\n  ");
       output_indices[index] = node_count;
-      if(node->root) PTF("(%d(R), ", node_count++);
+      if(nodeRoot(graph, index)) PTF("(%d(R), ", node_count++);
       else PTF("(%d, ", node_count++);
       printHostLabel(node->label, file);
       PTF(") ");
@@ -518,12 +1122,18 @@ void freeGraph(Graph *graph)
    {
       Node *node = getNode(graph, index);
       if(node == NULL) continue;
-      if(node->out_edges.items != NULL) free(node->out_edges.items);
-      if(node->in_edges.items != NULL) free(node->in_edges.items);
+      if(node->edges.items != NULL) free(node->edges.items);
       removeHostList(node->label.list);
    }
    if(graph->nodes.holes.items) free(graph->nodes.holes.items);
    if(graph->nodes.items) free(graph->nodes.items);
+   #ifdef HOT_COLD_SPLIT
+      free(graph->nodes.marks);
+      free(graph->nodes.roots);
+      free(graph->nodes.match_stamps);
+      free(graph->nodes.indegrees);
+      free(graph->nodes.outdegrees);
+   #endif
 
    for(index = 0; index < graph->edges.size; index++)
    {
@@ -533,16 +1143,25 @@ void freeGraph(Graph *graph)
    }
    if(graph->edges.holes.items) free(graph->edges.holes.items);
    if(graph->edges.items) free(graph->edges.items);
-   if(graph->root_nodes != NULL) 
-   {
-      RootNodes *iterator = graph->root_nodes;
-      while(iterator != NULL)
+   #ifdef HOT_COLD_SPLIT
+      free(graph->edges.marks);
+      free(graph->edges.match_stamps);
+   #endif
+   #ifdef EDGE_INDEX
+      free(graph->edge_index.buckets);
+   #endif
+   if(graph->root_nodes.items) free(graph->root_nodes.items);
+   free(graph->node_frontier.items);
+   free(graph->edge_frontier.items);
+   int mark, label_class;
+   for(mark = 0; mark < NUMBER_OF_MARKS; mark++)
+      for(label_class = 0; label_class < NUMBER_OF_CLASSES; label_class++)
       {
-         RootNodes *temp = iterator;
-         iterator = iterator->next;
-         free(temp);
+         if(graph->node_tables[mark][label_class].items != NULL)
+            free(graph->node_tables[mark][label_class].items);
+         if(graph->edge_tables[mark][label_class].items != NULL)
+            free(graph->edge_tables[mark][label_class].items);
       }
-   }
    free(graph);
 }
 
@@ -39,6 +39,13 @@
 #define NUMBER_OF_MARKS 6 
 #define NUMBER_OF_CLASSES 7
 
+/* Host labels are partitioned into label classes according to the length of
+ * their list and, for lists of length 1, the type of the atom. */
+typedef enum {EMPTY_L = 0, INT_L, STRING_L, LIST2_L, LIST3_L, LIST4_L, 
+              LONG_LIST_L} LabelClass;
+
+LabelClass getLabelClass(HostLabel label);
+
 typedef struct IntArray {
    int capacity;
    int size;
@@ -49,10 +56,22 @@ IntArray makeIntArray(int initial_capacity);
 void addToIntArray(IntArray *array, int item);
 void removeFromIntArray(IntArray *array, int index);
 
+/* With HOT_COLD_SPLIT defined, the node and edge arrays hold the cold data of
+ * the items, and the hot data is stored in the arrays below, which are parallel
+ * to the items array. The entries of a hole are zero, except for the mark. Use
+ * the accessor macros defined after the Node and Edge structures. */
 typedef struct NodeArray {
    int capacity;
    int size;
    struct Node *items;
+   #ifdef HOT_COLD_SPLIT
+      /* A copy of each node's mark, kept up to date by the label class table
+       * functions. */
+      unsigned char *marks;
+      bool *roots;
+      unsigned int *match_stamps;
+      int *indegrees, *outdegrees;
+   #endif
    struct IntArray holes;
 } NodeArray;
 
@@ -60,9 +79,26 @@ typedef struct EdgeArray {
    int capacity;
    int size;
    struct Edge *items;
+   #ifdef HOT_COLD_SPLIT
+      unsigned char *marks;
+      unsigned int *match_stamps;
+   #endif
    struct IntArray holes;
 } EdgeArray;
 
+#ifdef EDGE_INDEX
+/* A chained hash table of the edges keyed by (source, target). The chains are
+ * doubly linked through the edges themselves (see the Edge structure), so edges
+ * are entered and removed in constant time. The number of buckets is a power of
+ * 2 and is doubled when the table holds more edges than buckets. */
+typedef struct EdgeIndex {
+   int capacity;
+   int size;
+   /* The first edge in each bucket, or -1 if the bucket is empty. */
+   int *buckets;
+} EdgeIndex;
+#endif
+
 /* ================================
  * Graph Data Structure + Functions
  * ================================ */
@@ -81,10 +117,49 @@ typedef struct Graph
     * a dummy node (a hole created by the removal of a node), or a valid node. */
    int number_of_nodes, number_of_edges;
    
-   /* Root nodes referenced in a linked list for fast access. */
-   struct RootNodes *root_nodes;
+   /* Dense array of the indices of the root nodes for fast access. Each root
+    * node stores its position in this array, so that roots are added and 
+    * removed in constant time. */
+   IntArray root_nodes;
+
+   /* Items are marked as matched by stamping them with the current match epoch,
+    * so incrementing the epoch unmatches every item at once (see 
+    * resetMatchedFlags). Epochs start at 1: a stamp of 0 is never matched. */
+   unsigned int match_epoch;
+
+   /* Label class tables. Each table is a dense array of the indices of the
+    * nodes (edges) with a particular mark and label class. The matching code
+    * draws candidate items from the tables compatible with the rule item's label. */
+   IntArray node_tables[NUMBER_OF_MARKS][NUMBER_OF_CLASSES];
+   IntArray edge_tables[NUMBER_OF_MARKS][NUMBER_OF_CLASSES];
+
+   #ifdef EDGE_INDEX
+      EdgeIndex edge_index;
+   #endif
+
+   /* The dirty frontier: the indices of the nodes and edges added, relabelled,
+    * remarked or re-rooted since the last call to clearFrontier, and of the
+    * nodes whose incident edges have changed. At most FRONTIER_SIZE indices of
+    * each kind are recorded. The arrays may contain duplicates, and entries
+    * that refer to items removed since they were recorded are holes or -1. The
+    * matching code tries the recorded items as anchors before the rest of the
+    * graph, since the next match is often near the last modification. */
+   IntArray node_frontier, edge_frontier;
+
+   /* Modification epochs. An epoch is set to a new value of a clock shared by
+    * all graphs whenever an item enters or leaves the corresponding label class
+    * table, and the root epoch whenever a node enters or leaves the root node
+    * array. An epoch of 0 means that the table or array has been empty since
+    * the graph was created. The generated code compares the epochs that a rule
+    * depends on with those recorded at its last failure, and does not repeat
+    * the search if they are equal. */
+   unsigned long long node_epochs[NUMBER_OF_MARKS][NUMBER_OF_CLASSES];
+   unsigned long long edge_epochs[NUMBER_OF_MARKS][NUMBER_OF_CLASSES];
+   unsigned long long root_epoch;
 } Graph;
 
+#define FRONTIER_SIZE 32
+
 /* The arguments nodes and edges are the initial sizes of the node array and the
  * edge array respectively. */
 Graph *newGraph(int nodes, int edges);
@@ -101,59 +176,159 @@ void removeEdge(Graph *graph, int index);
 void relabelNode(Graph *graph, int index, HostLabel new_label);
 void changeNodeMark(Graph *graph, int index, MarkType new_mark);
 void changeRoot(Graph *graph, int index);
-void resetMatchedNodeFlag(Graph *graph, int index);
 void relabelEdge(Graph *graph, int index, HostLabel new_label);
 void changeEdgeMark(Graph *graph, int index, MarkType new_mark);
-void resetMatchedEdgeFlag(Graph *graph, int index);
+void resetMatchedFlags(Graph *graph);
+/* Empties the dirty frontier. Called by the generated code at the start of each
+ * rule application. */
+void clearFrontier(Graph *graph);
+
+/* Items are entered into and removed from the label class tables by the graph 
+ * modification functions above. These functions are exposed for the undo code
+ * in graphStacks.c, which reverses additions and removals manually. */
+void addToNodeTable(Graph *graph, int index);
+void removeFromNodeTable(Graph *graph, int index);
+void addToEdgeTable(Graph *graph, int index);
+void removeFromEdgeTable(Graph *graph, int index);
+
+/* Enters an edge into the incident edge arrays of its source and target at the
+ * given positions and into the edge index, and the converse operation. An
+ * out_position of -1 appends the edge to the source's outgoing edges. The undo
+ * code uses the positions recorded at removal to restore the exact order of the
+ * arrays. */
+void insertIncidentEdge(Graph *graph, int index, int out_position, int in_position);
+void removeIncidentEdge(Graph *graph, int index);
+
+#ifdef EDGE_INDEX
+/* Enters an edge into the edge index without touching the incident edge arrays.
+ * Used by copyGraph, which copies the incident edge arrays wholesale. */
+void addToEdgeIndex(Graph *graph, int index);
+#endif
+
+/* Renumbers the nodes and edges densely and shrinks the node and edge arrays
+ * if enough of their slots are holes. Otherwise it does nothing. Item indices
+ * held outside the graph are invalidated, so this must only be called when no
+ * morphism, restore point or graph change record refers to the host graph. */
+void compactGraph(Graph *graph);
 
 /* =========================
  * Node and Edge Definitions
  * ========================= */
 typedef struct Node {
    int index;
-   bool root;
    HostLabel label;
-   int outdegree, indegree;
-   int first_out_edge, second_out_edge;
-   int first_in_edge, second_in_edge;
-   /* Dynamic integer arrays for the node's outgoing and incoming edges. */
-   IntArray out_edges, in_edges;
-   bool matched;
+   /* Dynamic integer array of the node's incident edges: the indegree incoming
+    * edges followed by the outdegree outgoing edges. Use the incident edge
+    * functions below to access it. */
+   IntArray edges;
+   /* The node's position in its label class table. */
+   int table_index;
+   /* The node's position in the graph's root node array, or -1 if the node
+    * is not a root. */
+   int root_index;
+   #ifndef HOT_COLD_SPLIT
+      bool root;
+      int outdegree, indegree;
+      unsigned int match_stamp;
+   #endif
 } Node;
 
 extern struct Node dummy_node;
 
-typedef struct RootNodes {
-   int index;
-   struct RootNodes *next;
-} RootNodes;
-
 typedef struct Edge {
    int index;
    HostLabel label;
    int source, target;
-   bool matched;
+   /* The edge's positions in the incident edge arrays of its source and its
+    * target. */
+   int out_position, in_position;
+   /* The edge's position in its label class table. */
+   int table_index;
+   #ifdef EDGE_INDEX
+      /* The neighbours of the edge in its edge index bucket, or -1. */
+      int index_prev, index_next;
+   #endif
+   #ifndef HOT_COLD_SPLIT
+      unsigned int match_stamp;
+   #endif
 } Edge;
 
 extern struct Edge dummy_edge;
 
+/* Accessors for the fields tested by the candidate filters of the matching code.
+ * They take the graph and the item's index and work in either storage layout.
+ * Except for nodeMatched and edgeMatched, which compare the item's match stamp
+ * to the graph's epoch and are set with setNodeMatched and setEdgeMatched, they
+ * expand to lvalues. The marks are read-only: use changeNodeMark or 
+ * changeEdgeMark to modify them. The root flag is maintained by addRootNode and 
+ * removeRootNode, and the degrees by the incident edge functions. */
+#ifdef HOT_COLD_SPLIT
+   #define nodeMark(graph, index) ((graph)->nodes.marks[index])
+   #define nodeRoot(graph, index) ((graph)->nodes.roots[index])
+   #define nodeMatched(graph, index) \
+      ((graph)->nodes.match_stamps[index] == (graph)->match_epoch)
+   #define setNodeMatched(graph, index, matched) \
+      ((graph)->nodes.match_stamps[index] = (matched) ? (graph)->match_epoch : 0)
+   #define nodeIndegree(graph, index) ((graph)->nodes.indegrees[index])
+   #define nodeOutdegree(graph, index) ((graph)->nodes.outdegrees[index])
+   #define edgeMark(graph, index) ((graph)->edges.marks[index])
+   #define edgeMatched(graph, index) \
+      ((graph)->edges.match_stamps[index] == (graph)->match_epoch)
+   #define setEdgeMatched(graph, index, matched) \
+      ((graph)->edges.match_stamps[index] = (matched) ? (graph)->match_epoch : 0)
+#else
+   #define nodeMark(graph, index) ((graph)->nodes.items[index].label.mark)
+   #define nodeRoot(graph, index) ((graph)->nodes.items[index].root)
+   #define nodeMatched(graph, index) \
+      ((graph)->nodes.items[index].match_stamp == (graph)->match_epoch)
+   #define setNodeMatched(graph, index, matched) \
+      ((graph)->nodes.items[index].match_stamp = (matched) ? (graph)->match_epoch : 0)
+   #define nodeIndegree(graph, index) ((graph)->nodes.items[index].indegree)
+   #define nodeOutdegree(graph, index) ((graph)->nodes.items[index].outdegree)
+   #define edgeMark(graph, index) ((graph)->edges.items[index].label.mark)
+   #define edgeMatched(graph, index) \
+      ((graph)->edges.items[index].match_stamp == (graph)->match_epoch)
+   #define setEdgeMatched(graph, index, matched) \
+      ((graph)->edges.items[index].match_stamp = (matched) ? (graph)->match_epoch : 0)
+#endif
+
 /* ========================
  * Graph Querying Functions
  * ======================== */
 Node *getNode(Graph *graph, int index);
 Edge *getEdge(Graph *graph, int index);
-RootNodes *getRootNodeList(Graph *graph);
-
-/* Called with a positive integer n. The node structures store two outedge indices
- * and two inedge indices. More incident edges are placed in a dynamic array.
- * Pass n = 0 to get the node's first incident edge.
- * Pass n = 1 to get the node's second incident edge.
- * Pass n >= 2 to get the (n-2)th incident edge in the appropriate array. 
- * Designed for iteration e.g. 
- * for(i = 0; i < n->out_edges.size + 2; i++) getNthOutEdge(g, n, i); 
- * I'm sure there's a nicer way to do this... */
-Edge *getNthOutEdge(Graph *graph, Node *node, int n);
-Edge *getNthInEdge(Graph *graph, Node *node, int n);
+IntArray *getRootNodeList(Graph *graph);
+IntArray *getNodeFrontier(Graph *graph);
+IntArray *getEdgeFrontier(Graph *graph);
+IntArray *getNodeTable(Graph *graph, MarkType mark, LabelClass label_class);
+IntArray *getEdgeTable(Graph *graph, MarkType mark, LabelClass label_class);
+
+/* Incident edge iteration. Each function returns a pointer to a contiguous
+ * range of edge indices without holes: the node's indegree incoming edges,
+ * its outdegree outgoing edges, or all indegree + outdegree incident edges
+ * (incoming first). A loop occurs in both the incoming and outgoing range.
+ * For example:
+ *
+ * int *out_edges = getOutEdges(graph, node), counter;
+ * for(counter = 0; counter < nodeOutdegree(graph, node->index); counter++)
+ *    Edge *edge = getEdge(graph, out_edges[counter]);
+ *
+ * The pointers are invalidated by the addition or removal of edges incident
+ * to the node. */
+int *getInEdges(Graph *graph, Node *node);
+int *getOutEdges(Graph *graph, Node *node);
+int *getIncidentEdges(Graph *graph, Node *node);
+/* Iteration over the edges from a source node to a target node, given by
+ * their indices, in no particular order. Each function returns the index of an
+ * edge, or -1 if there are no more edges. For example:
+ *
+ * int index;
+ * for(index = firstEdgeBetween(graph, source, target); index >= 0;
+ *     index = nextEdgeBetween(graph, index))
+ *
+ * The graph must not be modified during the iteration. */
+int firstEdgeBetween(Graph *graph, int source, int target);
+int nextEdgeBetween(Graph *graph, int index);
 Node *getSource(Graph *graph, Edge *edge); 
 Node *getTarget(Graph *graph, Edge *edge);
 HostLabel getNodeLabel(Graph *graph, int index);
@@ -111,7 +111,8 @@ void pushRemovedNode(bool root, HostLabel label, int index, bool hole_created)
    pushGraphChange(change);
 }
 
-void pushRemovedEdge(HostLabel label, int source, int target, int index, bool hole_created)
+void pushRemovedEdge(HostLabel label, int source, int target, int out_position,
+                     int in_position, int index, bool hole_created)
 {
    GraphChange change;
    change.type = REMOVED_EDGE;
@@ -125,6 +126,8 @@ void pushRemovedEdge(HostLabel label, int source, int target, int index, bool ho
    #endif
    change.removed_edge.source = source;
    change.removed_edge.target = target;
+   change.removed_edge.out_position = out_position;
+   change.removed_edge.in_position = in_position;
    change.removed_edge.index = index;
    change.removed_edge.hole_created = hole_created;
    pushGraphChange(change);
@@ -207,10 +210,11 @@ void undoChanges(Graph *graph, int restore_point)
               int index = change.added_node.index;
               Node *node = getNode(graph, index);  
 
-              if(node->out_edges.items != NULL) free(node->out_edges.items);
-              if(node->in_edges.items != NULL) free(node->in_edges.items); 
-              if(node->root) removeRootNode(graph, index);
+              if(node->edges.items != NULL) free(node->edges.items);
+              if(nodeRoot(graph, index)) removeRootNode(graph, index);
+              removeFromNodeTable(graph, index);
               removeHostList(node->label.list);
+              setNodeMatched(graph, index, false);
 
               if(change.added_node.hole_filled) 
                  graph->nodes.holes.items[graph->nodes.holes.size++] = index;
@@ -226,18 +230,12 @@ void undoChanges(Graph *graph, int restore_point)
               int index = change.added_edge.index;
               Edge *edge = getEdge(graph, index);
 
-              Node *source = getNode(graph, edge->source);
-              if(source->first_out_edge == index) source->first_out_edge = -1;
-              else if(source->second_out_edge == index) source->second_out_edge = -1;
-              else removeFromIntArray(&(source->out_edges), index);
-              source->outdegree--;
-
-              Node *target = getNode(graph, edge->target);
-              if(target->first_in_edge == index) target->first_in_edge = -1;
-              else if(target->second_in_edge == index) target->second_in_edge = -1;
-              else removeFromIntArray(&(target->in_edges), index);
-              target->indegree--;
+              /* The edge is the last edge of its range in the incident edge arrays
+               * of its source and target, so this restores their previous order. */
+              removeIncidentEdge(graph, index);
+              removeFromEdgeTable(graph, index);
               removeHostList(edge->label.list);
+              setEdgeMatched(graph, index, false);
 
               if(change.added_edge.hole_filled)
                  graph->edges.holes.items[graph->edges.holes.size++] = index;
@@ -249,19 +247,10 @@ void undoChanges(Graph *graph, int restore_point)
          }
          case REMOVED_NODE:
          {
-              Node node;
+              Node node = dummy_node;
               node.index = change.removed_node.index;
-              node.root = change.removed_node.root;
               node.label = change.removed_node.label;
-              node.first_out_edge = -1;
-              node.second_out_edge = -1;
-              node.first_in_edge = -1;
-              node.second_in_edge = -1;
-              node.out_edges = makeIntArray(0);
-              node.in_edges = makeIntArray(0);
-              node.outdegree = 0;
-              node.indegree = 0;
-	      node.matched = false;
+              node.edges = makeIntArray(0);
 
               graph->nodes.items[change.removed_node.index] = node;
               /* If the removal of the node created a hole, manually remove it from
@@ -272,34 +261,20 @@ void undoChanges(Graph *graph, int restore_point)
                  graph->nodes.holes.items[graph->nodes.holes.size] = -1;
               }
               else graph->nodes.size++;
-              if(node.root) addRootNode(graph, change.removed_node.index);
+              addToNodeTable(graph, change.removed_node.index);
+              if(change.removed_node.root) addRootNode(graph, change.removed_node.index);
               graph->number_of_nodes++;
               break;
          }
          case REMOVED_EDGE:
          {
-              Edge edge;
+              Edge edge = dummy_edge;
               edge.index = change.removed_edge.index;
               edge.label = change.removed_edge.label;
               edge.source = change.removed_edge.source;
               edge.target = change.removed_edge.target;
-	      edge.matched = false;
  
               graph->edges.items[change.removed_edge.index] = edge;
-
-              Node *source = getNode(graph, change.removed_edge.source);
-              assert(source != NULL);
-              if(source->first_out_edge == -1) source->first_out_edge = edge.index;
-              else if(source->second_out_edge == -1) source->second_out_edge = edge.index;
-              else addToIntArray(&(source->out_edges), edge.index);
-              source->outdegree++;
-
-              Node *target = getNode(graph, change.removed_edge.target);
-              assert(target != NULL);
-              if(target->first_in_edge == -1) target->first_in_edge = edge.index;
-              else if(target->second_in_edge == -1) target->second_in_edge = edge.index;
-              else addToIntArray(&(target->in_edges), edge.index);
-              target->indegree++;
               /* If the removal of the edge created a hole, manually remove it from
                * the holes array. */
               if(change.removed_edge.hole_created)
@@ -308,6 +283,11 @@ void undoChanges(Graph *graph, int restore_point)
                  graph->edges.holes.items[graph->edges.holes.size] = -1;
               }
               else graph->edges.size++;
+              /* Restore the edge to its original positions in the incident edge
+               * arrays of its source and target. */
+              insertIncidentEdge(graph, edge.index, change.removed_edge.out_position,
+                                 change.removed_edge.in_position);
+              addToEdgeTable(graph, change.removed_edge.index);
               graph->number_of_edges++;
               break;
          }
@@ -420,6 +400,18 @@ void copyGraph(Graph *graph)
    graph_copy->edges.capacity = graph->edges.capacity;
    memcpy(graph_copy->edges.items, graph->edges.items, graph->edges.capacity * sizeof(Edge));
 
+   #ifdef HOT_COLD_SPLIT
+      /* The marks are copied by addToNodeTable and addToEdgeTable below, and the
+       * root flags by addRootNode. */
+      int capacity = graph->nodes.capacity;
+      memcpy(graph_copy->nodes.match_stamps, graph->nodes.match_stamps,
+             capacity * sizeof(unsigned int));
+      memcpy(graph_copy->nodes.indegrees, graph->nodes.indegrees, capacity * sizeof(int));
+      memcpy(graph_copy->nodes.outdegrees, graph->nodes.outdegrees, capacity * sizeof(int));
+      memcpy(graph_copy->edges.match_stamps, graph->edges.match_stamps, 
+             graph->edges.capacity * sizeof(unsigned int));
+   #endif
+
    /* newGraph allocates an initial holes array of size 16. This may be smaller
     * then the holes array in the original graph. */
    if(graph_copy->nodes.holes.capacity < graph->nodes.holes.capacity)
@@ -454,7 +446,7 @@ void copyGraph(Graph *graph)
    
    graph_copy->number_of_nodes = graph->number_of_nodes;
    graph_copy->number_of_edges = graph->number_of_edges;
-   graph_copy->root_nodes = NULL;
+   graph_copy->match_epoch = graph->match_epoch;
  
    int index;
    for(index = 0; index < graph_copy->nodes.size; index++)
@@ -465,31 +457,21 @@ void copyGraph(Graph *graph)
       if(node_copy->index >= 0)
       {
          Node *node = getNode(graph, index);
-         /* If necessary, copy the edges arrays of the original node. */
-         if(node->out_edges.items != NULL)
-         {
-            node_copy->out_edges.items = calloc(node_copy->out_edges.size, sizeof(int));
-            if(node_copy->out_edges.items == NULL)
-            {
-               print_to_log("Error: (copyGraph): malloc failure.\n");
-               exit(1);
-            }
-            memcpy(node_copy->out_edges.items, node->out_edges.items,
-                   node_copy->out_edges.size * sizeof(int));
-         }
-         if(node->in_edges.items != NULL)
+         /* If necessary, copy the incident edges array of the original node. */
+         if(node->edges.items != NULL)
          {
-            node_copy->in_edges.items = calloc(node_copy->in_edges.size, sizeof(int));
-            if(node_copy->in_edges.items == NULL)
+            node_copy->edges.items = calloc(node_copy->edges.capacity, sizeof(int));
+            if(node_copy->edges.items == NULL)
             {
                print_to_log("Error: (copyGraph): malloc failure.\n");
                exit(1);
             }
-            memcpy(node_copy->in_edges.items, node->in_edges.items,
-                   node_copy->in_edges.size * sizeof(int));
+            memcpy(node_copy->edges.items, node->edges.items,
+                   node_copy->edges.capacity * sizeof(int));
          }
-         /* Populate the root nodes list. */
-         if(node_copy->root) addRootNode(graph_copy, node_copy->index);
+         /* Populate the root nodes list and the label class tables. */
+         if(nodeRoot(graph, index)) addRootNode(graph_copy, node_copy->index);
+         addToNodeTable(graph_copy, node_copy->index);
          #ifdef LIST_HASHING
             addHostList(node->label.list);
          #else
@@ -503,6 +485,10 @@ void copyGraph(Graph *graph)
       if(edge_copy->index >= 0)
       {
          HostLabel label = getEdgeLabel(graph, index);
+         addToEdgeTable(graph_copy, edge_copy->index);
+         #ifdef EDGE_INDEX
+            addToEdgeIndex(graph_copy, edge_copy->index);
+         #endif
          #ifdef LIST_HASHING
             addHostList(label.list);
          #else
@@ -69,13 +69,16 @@ typedef struct GraphChange
          int index;
          bool hole_created;
       } removed_node;
-      /* Records the label, source and target of the removed edge, along with its 
-       * index in the edge array and a flag set to true if the removal of this
-       * edge created a hole in the edge array. */
+      /* Records the label, source and target of the removed edge, its positions
+       * in the incidence lists of its source and target, along with its index
+       * in the edge array and a flag set to true if the removal of this edge
+       * created a hole in the edge array. */
       struct {
          HostLabel label;
          int source;
          int target;
+         int out_position;
+         int in_position;
          int index;
          bool hole_created;
       } removed_edge;
@@ -102,7 +105,8 @@ int topOfGraphChangeStack(void);
 void pushAddedNode(int index, bool hole_filled);
 void pushAddedEdge(int index, bool hole_filled);
 void pushRemovedNode(bool root, HostLabel label, int index, bool hole_created);
-void pushRemovedEdge(HostLabel label, int source, int target, int index, bool hole_created);
+void pushRemovedEdge(HostLabel label, int source, int target, int out_position,
+                     int in_position, int index, bool hole_created);
 void pushRelabelledNode(int index, HostLabel old_label);
 void pushRelabelledEdge(int index, HostLabel old_label);
 void pushRemarkedNode(int index, MarkType old_mark);
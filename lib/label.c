@@ -15,217 +15,327 @@
 
 #include "label.h"
 
-HostLabel blank_label = {NONE, 0, NULL};
+#include <stdint.h>
 
-#ifdef LIST_HASHING
-Bucket **list_store = NULL;
-
-/* The list hash table has 400 buckets. It is structured as follows:
- * Lists of length 1 occupy buckets 0 - 99.
- * Lists of length 2 occupy buckets 100 - 199.
- * Lists of length 3 occupy buckets 200 - 299.
- * Lists of length > 3 occupy buckets 300 - 399.
- * The first unit in the first atom (an integer or the first character of a string)
- * gives the index to add to the 'base' (the appropriate multiple of 100) as defined
- * in the function. */
-static unsigned hashHostList(HostAtom *list, int length)
+HostLabel blank_label = {NONE, 0, NULL, {0}};
+
+/* The hashes of strings and lists are computed by mixing in one 64-bit word at
+ * a time with a multiply and a shift, and finalised with the MurmurHash3 64-bit
+ * finaliser, so that the low bits used to select a slot depend on every input bit. */
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ull
+
+static uint64_t mixHashWord(uint64_t hash, uint64_t word)
 {
-   unsigned hash = 0;
-   int index;
-   for(index = 0; index < length; index++)
+   hash = (hash ^ word) * HASH_MULTIPLIER;
+   return hash ^ (hash >> 32);
+}
+
+static unsigned int finaliseHash(uint64_t hash)
+{
+   hash ^= hash >> 33;
+   hash *= 0xFF51AFD7ED558CCDull;
+   hash ^= hash >> 33;
+   hash *= 0xC4CEB9FE1A85EC53ull;
+   hash ^= hash >> 33;
+   return (unsigned int)hash;
+}
+
+/* ================
+ * String Interning 
+ * ================ */
+static InternedString **string_table = NULL;
+static int string_table_slots = 0;
+static int string_table_size = 0;
+
+/* Strings are consumed 8 bytes at a time. */
+static unsigned int hashString(const char *str, size_t length)
+{
+   uint64_t hash = mixHashWord(0, (uint64_t)length);
+   size_t offset = 0;
+   for(; offset + 8 <= length; offset += 8)
    {
-      HostAtom atom = list[index];
-      int value = atom.type == 'i' ? atom.num : atom.str[0];
-      hash = ((hash << 5) + hash) + value; /* hash = hash * 33 + value */
+      uint64_t word;
+      memcpy(&word, str + offset, 8);
+      hash = mixHashWord(hash, word);
    }
-   return hash % LIST_TABLE_SIZE ;
+   if(offset < length)
+   {
+      uint64_t word = 0;
+      memcpy(&word, str + offset, length - offset);
+      hash = mixHashWord(hash, word);
+   }
+   return finaliseHash(hash);
 }
-#endif
 
-static HostList *appendHostAtom(HostList *list, HostAtom atom, bool free_strings)
+static void resizeStringTable(int slots)
 {
-   HostListItem *new_item = malloc(sizeof(HostListItem));
-   if(new_item == NULL)
+   InternedString **table = calloc(slots, sizeof(InternedString*));
+   if(table == NULL)
    {
-      print_to_log("Error (appendAtom): malloc failure.\n");
+      print_to_log("Error (resizeStringTable): malloc failure.\n");
       exit(1);
    }
-   new_item->atom = atom;
-   if(atom.type == 's') 
+   int index;
+   for(index = 0; index < string_table_slots; index++)
    {
-      if(free_strings) new_item->atom.str = atom.str;
-      else new_item->atom.str = strdup(atom.str);
+      InternedString *entry = string_table[index];
+      while(entry != NULL)
+      {
+         InternedString *next = entry->next;
+         int slot = entry->hash & (slots - 1);
+         entry->next = table[slot];
+         table[slot] = entry;
+         entry = next;
+      }
    }
-   new_item->next = NULL;
+   if(string_table != NULL) free(string_table);
+   string_table = table;
+   string_table_slots = slots;
+}
 
-   if(list == NULL)
+string internString(const char *str)
+{
+   if(string_table == NULL) resizeStringTable(STRING_TABLE_INITIAL_SIZE);
+   size_t length = strlen(str);
+   unsigned int hash = hashString(str, length);
+   int slot = hash & (string_table_slots - 1);
+   InternedString *entry;
+   for(entry = string_table[slot]; entry != NULL; entry = entry->next)
    {
-      new_item->prev = NULL;
-      HostList *new_list = malloc(sizeof(HostList));
-      if(new_list == NULL)
+      if(entry->hash == hash && entry->length == (int)length && 
+         memcmp(entry->chars, str, length) == 0)
       {
-         print_to_log("Error (appendAtom): malloc failure.\n");
-         exit(1);
+         entry->reference_count++;
+         return entry->chars;
       }
-      new_list->hash = -1;
-      new_list->first = new_item;
-      new_list->last = new_item;
-      return new_list;
    }
-   else
+   entry = poolAlloc(sizeof(InternedString) + length + 1);
+   entry->hash = hash;
+   entry->length = length;
+   entry->reference_count = 1;
+   memcpy(entry->chars, str, length + 1);
+   entry->next = string_table[slot];
+   string_table[slot] = entry;
+   if(++string_table_size > string_table_slots) resizeStringTable(2 * string_table_slots);
+   return entry->chars;
+}
+
+void addInternedString(string str)
+{
+   getInternedString(str)->reference_count++;
+}
+
+void removeInternedString(string str)
+{
+   if(str == NULL) return;
+   InternedString *entry = getInternedString(str);
+   if(--entry->reference_count > 0) return;
+   InternedString **link = &(string_table[entry->hash & (string_table_slots - 1)]);
+   while(*link != entry) link = &((*link)->next);
+   *link = entry->next;
+   poolFree(entry, sizeof(InternedString) + entry->length + 1);
+   string_table_size--;
+   if(string_table_slots > STRING_TABLE_INITIAL_SIZE && 
+      8 * string_table_size < string_table_slots) 
+      resizeStringTable(string_table_slots / 2);
+}
+
+void freeStringTable(void)
+{
+   if(string_table == NULL) return;
+   int index;
+   for(index = 0; index < string_table_slots; index++)
    {
-      list->last->next = new_item;
-      new_item->prev = list->last;
-      list->last = new_item;
-      return list;
+      InternedString *entry = string_table[index];
+      while(entry != NULL)
+      {
+         InternedString *next = entry->next;
+         poolFree(entry, sizeof(InternedString) + entry->length + 1);
+         entry = next;
+      }
    }
+   free(string_table);
+   string_table = NULL;
+   string_table_slots = 0;
+   string_table_size = 0;
 }
 
 #ifdef LIST_HASHING
-/* Create a new bucket, allocate a list defined by the function arguments, and
- * point the bucket to that list. */
-static Bucket *makeBucket(HostAtom *array, int length, bool free_strings)
+HostList **list_store = NULL;
+static int list_store_slots = 0;
+static int list_store_size = 0;
+
+/* Hashes the whole contents of the list: its length and the type and value of
+ * each atom. The atoms' strings are interned, so their cached hashes are used. */
+static unsigned int hashHostList(HostAtom *list, int length)
+{
+   uint64_t hash = mixHashWord(0, (uint64_t)length);
+   int index;
+   for(index = 0; index < length; index++)
+   {
+      HostAtom atom = list[index];
+      if(atom.type == 'i') 
+         hash = mixHashWord(hash, ((uint64_t)'i' << 32) | (uint32_t)atom.num);
+      else 
+         hash = mixHashWord(hash, ((uint64_t)'s' << 32) | getInternedString(atom.str)->hash);
+   }
+   return finaliseHash(hash);
+}
+
+/* Compares two lists of interned atoms. */
+static bool identicalHostLists(HostAtom *left_list, HostAtom *right_list, int length)
+{
+   int index;
+   for(index = 0; index < length; index++)
+   {
+      if(left_list[index].type != right_list[index].type) return false;
+      if(left_list[index].type == 'i')
+      {
+         if(left_list[index].num != right_list[index].num) return false;
+      }
+      else if(left_list[index].str != right_list[index].str) return false;
+   }
+   return true;
+}
+
+static HostList **makeListStore(int slots)
 {
-   Bucket *bucket = malloc(sizeof(Bucket));
-   if(bucket == NULL)
+   HostList **store = calloc(slots, sizeof(HostList*));
+   if(store == NULL)
    {
-      print_to_log("Error (makeBucket): malloc failure.\n");
+      print_to_log("Error (makeListStore): malloc failure.\n");
       exit(1);
    }
-   HostList *list = NULL;
+   return store;
+}
+
+/* Moves every list into a table with the given number of slots. The full
+ * hashes are stored in the lists, so no list is rehashed. */
+static void resizeListStore(int slots)
+{
+   HostList **store = makeListStore(slots);
    int index;
-   for(index = 0; index < length; index++) 
-      list = appendHostAtom(list, array[index], free_strings);
-   bucket->list = list;
-   bucket->reference_count = 1;
-   bucket->next = NULL;
-   bucket->prev = NULL;
-   return bucket;
+   for(index = 0; index < list_store_slots; index++)
+   {
+      HostList *list = list_store[index];
+      while(list != NULL)
+      {
+         HostList *next = list->next;
+         int slot = list->hash & (slots - 1);
+         list->prev = NULL;
+         list->next = store[slot];
+         if(store[slot] != NULL) store[slot]->prev = list;
+         store[slot] = list;
+         list = next;
+      }
+   }
+   free(list_store);
+   list_store = store;
+   list_store_slots = slots;
+}
+
+ListStoreStats getListStoreStats(void)
+{
+   ListStoreStats stats = {list_store_size, list_store_slots, 0, 0};
+   int index;
+   for(index = 0; index < list_store_slots; index++)
+   {
+      int chain = 0;
+      HostList *list;
+      for(list = list_store[index]; list != NULL; list = list->next) chain++;
+      if(chain > 0) stats.used_slots++;
+      if(chain > stats.longest_chain) stats.longest_chain = chain;
+   }
+   return stats;
+}
+
+void printListStoreStats(FILE *file)
+{
+   ListStoreStats stats = getListStoreStats();
+   fprintf(file, "List store: %d lists in %d slots, %d slots used, longest chain %d, "
+           "average chain %.2f.\n", stats.lists, stats.slots, stats.used_slots,
+           stats.longest_chain, 
+           stats.used_slots == 0 ? 0.0 : (double)stats.lists / stats.used_slots);
 }
 #endif
 
+/* Allocates a list holding a copy of the passed array of interned atoms. The
+ * list takes over the caller's references to the strings. */
+static HostList *allocateHostList(HostAtom *array, int length)
+{
+   HostList *list = poolAlloc(sizeof(HostList) + length * sizeof(HostAtom));
+   list->hash = 0;
+   list->length = length;
+   list->reference_count = 1;
+   list->next = NULL;
+   list->prev = NULL;
+   memcpy(list->atoms, array, length * sizeof(HostAtom));
+   return list;
+}
+
+
 /* Adds a host list, represented by the passed array and its length, to the hash
  * table. The array and the length is passed to the hashing function. 
  *
- * The free_strings flag is true if the strings in the passed array have already
- * been allocated by the caller. It controls the freeing of such strings in the
- * case that the passed list already exists in the hash table. 
- * This is a necessary inconvenience: addListToStore is called by the Bison/Flex generated
- * host graph parser which requires the strings it parses to be strdup'd (otherwise 
- * things go wrong). Calls to addListToStore in other contexts pass arrays with 
- * automatic strings which should not be freed. */
+ * The free_strings flag is true if the strings in the passed array are interned
+ * strings whose references are passed to this function by the caller, which is
+ * the case for the strings created by the host graph parser. Otherwise, the 
+ * strings may be any strings, such as automatic strings or string constants,
+ * and they are left untouched. */
 HostList *makeHostList(HostAtom *array, int length, bool free_strings)
 {
+   /* Intern the strings, taking a reference to each of them. */
+   HostAtom atoms[length];
+   int index;
+   for(index = 0; index < length; index++)
+   {
+      atoms[index] = array[index];
+      if(array[index].type == 's' && !free_strings) 
+         atoms[index].str = internString(array[index].str);
+   }
    #ifdef LIST_HASHING
       if(list_store == NULL)
       {
-         list_store = calloc(LIST_TABLE_SIZE, sizeof(Bucket*));
-         if(list_store == NULL)
-         {
-            print_to_log("Error(addListToStore): malloc failure.\n");
-            exit(1);
-         }
-      }
-      int hash = hashHostList(array, length);
-      if(list_store[hash] == NULL)
-      {
-         Bucket *bucket = makeBucket(array, length, free_strings);
-         list_store[hash] = bucket;
-         bucket->list->hash = hash;
-         return bucket->list;
+         list_store = makeListStore(LIST_STORE_INITIAL_SIZE);
+         list_store_slots = LIST_STORE_INITIAL_SIZE;
       }
-      /* Check each list in the bucket for equality with the list represented
-       * by the passed array. */
-      else
+      unsigned int hash = hashHostList(atoms, length);
+      int slot = hash & (list_store_slots - 1);
+      /* Check each list with the same hash in the slot for equality with the list
+       * represented by the passed array. */
+      HostList *list;
+      for(list = list_store[slot]; list != NULL; list = list->next)
       {
-         Bucket *bucket = list_store[hash];
-         int index;
-         bool make_bucket = true;
-         while(bucket != NULL)
+         if(list->hash != hash || list->length != length) continue;
+         if(identicalHostLists(list->atoms, atoms, length))
          {
-            HostListItem *item = bucket->list->first;
+            list->reference_count++;
             for(index = 0; index < length; index++) 
-            {
-               if(item == NULL) break;
-               HostAtom atom = array[index];
-               if(item->atom.type != atom.type) break;
-               if(item->atom.type == 'i') 
-               {
-                  if(item->atom.num != atom.num) break;
-               }
-               else
-               {
-                  if(strcmp(item->atom.str, atom.str) != 0) break;
-               }
-               item = item->next;
-            }
-            /* The lists are equal if and only if the ends of both lists are reached.
-             * If an atom comparison failed, the for loop breaks before the end of
-             * either list is reached. If the array is shorter, then the for loop
-             * exits before item reaches its terminating NULL pointer. If the list
-             * is shorter, the first line in the for loop body will cause the loop
-             * to break before index == length. */
-            if(index == length && item == NULL)
-            {
-               make_bucket = false; 
-               break;
-            }
-            /* Exit the loop while maintaining the pointer to the last item in the
-             * bucket list, because a list is going to be appended! */
-            if(bucket->next == NULL) break;
-            bucket = bucket->next;
-         }
-         /* If control reaches this point, then no list in the bucket is equal to
-          * the passed list. Make a new list! */
-         if(make_bucket)
-         {
-            Bucket *new_bucket = makeBucket(array, length, free_strings);
-            bucket->next = new_bucket;
-            new_bucket->prev = bucket;
-            new_bucket->list->hash = hash;
-            return new_bucket->list;
-         }
-         else 
-         {
-            bucket->reference_count++;
-            if(free_strings)
-            {
-               for(index = 0; index < length; index++) 
-                  if(array[index].type == 's') free(array[index].str);
-            }
-            return bucket->list;
+               if(atoms[index].type == 's') removeInternedString(atoms[index].str);
+            return list;
          }
       }
-   #else
-      HostList *list = NULL;
-      int index;
-      for(index = 0; index < length; index++) 
-         list = appendHostAtom(list, array[index], free_strings);
+      /* If control reaches this point, then no list in the slot is equal to
+       * the passed list. Make a new list and add it to the front of the slot. */
+      list = allocateHostList(atoms, length);
+      list->hash = hash;
+      list->next = list_store[slot];
+      if(list_store[slot] != NULL) list_store[slot]->prev = list;
+      list_store[slot] = list;
+      if(++list_store_size > list_store_slots) resizeListStore(2 * list_store_slots);
       return list;
+   #else
+      return allocateHostList(atoms, length);
    #endif
 }
 
 #ifdef LIST_HASHING
-/* Returns the bucket containing the passed list. */
-static Bucket *getBucket(HostList *list)
-{
-   Bucket *bucket = list_store[list->hash];
-   assert(bucket != NULL);
-   while(bucket != NULL)
-   {
-      if(bucket->list == list) return bucket;
-      bucket = bucket->next;
-   } 
-   return NULL;
-}
-
 void addHostList(HostList *list)
 {
    if(list == NULL) return;
-   Bucket *bucket = getBucket(list); 
    /* The passed list is expected to exist in the host table. */
-   assert(bucket != NULL);
-   bucket->reference_count++;
+   assert(list->reference_count > 0);
+   list->reference_count++;
 }
 #endif
 
@@ -233,18 +343,21 @@ void removeHostList(HostList *list)
 {
    if(list == NULL) return;
    #ifdef LIST_HASHING
-      Bucket *bucket = getBucket(list); 
       /* The passed list is expected to exist in the host table. */
-      assert(bucket != NULL);
-      bucket->reference_count--;
-      if(bucket->reference_count == 0)
+      assert(list->reference_count > 0);
+      list->reference_count--;
+      if(list->reference_count == 0)
       {
-         /* Delete the bucket. */
-         if(bucket->prev == NULL) list_store[list->hash] = bucket->next;
-         else bucket->prev->next = bucket->next;
-         if(bucket->next != NULL) bucket->next->prev = bucket->prev;
+         /* Unlink the list from its slot. */
+         if(list->prev == NULL) 
+            list_store[list->hash & (list_store_slots - 1)] = list->next;
+         else list->prev->next = list->next;
+         if(list->next != NULL) list->next->prev = list->prev;
          freeHostList(list);
-         free(bucket);
+         list_store_size--;
+         if(list_store_slots > LIST_STORE_INITIAL_SIZE && 
+            8 * list_store_size < list_store_slots) 
+            resizeListStore(list_store_slots / 2);
       }
    #else
       freeHostList(list);
@@ -257,17 +370,67 @@ HostLabel makeEmptyLabel(MarkType mark)
    return label;
 }
 
+static bool inlineAtoms(HostAtom *array, int length)
+{
+   if(length > INLINE_LABEL_LENGTH) return false;
+   int index;
+   for(index = 0; index < length; index++)
+      if(array[index].type != 'i') return false;
+   return true;
+}
+
+static HostLabel makeInlineLabel(MarkType mark, int length, HostAtom *array)
+{
+   HostLabel label = { .mark = mark, .length = length, .list = NULL };
+   int index;
+   for(index = 0; index < length; index++) label.inline_list[index] = array[index].num;
+   return label;
+}
+
 HostLabel makeHostLabel(MarkType mark, int length, HostList *list)
 {
+   if(list != NULL && inlineAtoms(list->atoms, length))
+   {
+      HostLabel label = makeInlineLabel(mark, length, list->atoms);
+      removeHostList(list);
+      return label;
+   }
    HostLabel label = { .mark = mark, .length = length, .list = list };
    return label;
 }
 
+HostLabel makeHostLabelFromAtoms(MarkType mark, int length, HostAtom *array,
+                                 bool free_strings)
+{
+   if(inlineAtoms(array, length)) return makeInlineLabel(mark, length, array);
+   HostLabel label = { .mark = mark, .length = length, 
+                       .list = makeHostList(array, length, free_strings) };
+   return label;
+}
+
+HostAtom *expandInlineList(HostLabel *label, HostAtom *buffer)
+{
+   int index;
+   for(index = 0; index < label->length; index++)
+   {
+      buffer[index].type = 'i';
+      buffer[index].num = label->inline_list[index];
+   }
+   return buffer;
+}
+
 bool equalHostLabels(HostLabel label1, HostLabel label2)
 {
    if(label1.mark != label2.mark) return false;
    if(label1.length != label2.length) return false;
    if(label1.list != label2.list) return false;
+   /* Both lists are stored inline or both are empty. */
+   if(label1.list == NULL)
+   {
+      int index;
+      for(index = 0; index < label1.length; index++)
+         if(label1.inline_list[index] != label2.inline_list[index]) return false;
+   }
    return true;
 }
 
@@ -286,7 +449,8 @@ bool equalHostLists(HostAtom *left_list, HostAtom *right_list,
       {
          if(left_atom.num != right_atom.num) return false;
       }
-      else if(strcmp(left_atom.str, right_atom.str) != 0) return false;
+      else if(left_atom.str != right_atom.str && strcmp(left_atom.str, right_atom.str) != 0) 
+         return false;
    }
    return true;
 }
@@ -294,20 +458,19 @@ bool equalHostLists(HostAtom *left_list, HostAtom *right_list,
 HostList *copyHostList(HostList *list)
 {
    if(list == NULL) return NULL;
-   HostList *list_copy = NULL;
-   HostListItem *item = list->first;
-   while(item != NULL)
-   {
-      list_copy = appendHostAtom(list_copy, item->atom, false);
-      item = item->next;
-   }
+   HostList *list_copy = allocateHostList(list->atoms, list->length);
+   list_copy->hash = list->hash;
+   int index;
+   for(index = 0; index < list->length; index++)
+      if(list->atoms[index].type == 's') addInternedString(list->atoms[index].str);
    return list_copy;
 }
    
 void printHostLabel(HostLabel label, FILE *file) 
 {
+   HostAtom buffer[INLINE_LABEL_LENGTH];
    if(label.length == 0) fprintf(file, "empty");
-   else printHostList(label.list->first, file);
+   else printHostList(hostLabelAtoms(label, buffer), label.length, file);
    if(label.mark == RED) fprintf(file, " # red"); 
    if(label.mark == GREEN) fprintf(file, " # green");
    if(label.mark == BLUE) fprintf(file, " # blue");
@@ -315,47 +478,45 @@ void printHostLabel(HostLabel label, FILE *file)
    if(label.mark == DASHED) fprintf(file, " # dashed");
 }
 
-void printHostList(HostListItem *item, FILE *file)
+void printHostList(HostAtom *atoms, int length, FILE *file)
 {
-   while(item != NULL)
+   int index;
+   for(index = 0; index < length; index++)
    {
-      if(item->atom.type == 'i') fprintf(file, "%d", item->atom.num);
-      else fprintf(file, "\"%s\"", item->atom.str);
-      if(item->next != NULL) fprintf(file, " : ");
-      item = item->next;
+      if(atoms[index].type == 'i') fprintf(file, "%d", atoms[index].num);
+      else fprintf(file, "\"%s\"", atoms[index].str);
+      if(index < length - 1) fprintf(file, " : ");
    }
 }
 
-static void freeHostListItems(HostListItem *item)
-{
-   if(item == NULL) return;
-   if(item->atom.type == 's') free(item->atom.str);
-   freeHostListItems(item->next);
-   free(item);
-}
-
 void freeHostList(HostList *list)
 {
    if(list == NULL) return;
-   freeHostListItems(list->first);
-   free(list);
+   int index;
+   for(index = 0; index < list->length; index++)
+      if(list->atoms[index].type == 's') removeInternedString(list->atoms[index].str);
+   poolFree(list, sizeof(HostList) + list->length * sizeof(HostAtom));
 }
 
 
 #ifdef LIST_HASHING
-static void freeBuckets(Bucket *bucket)
-{
-   if(bucket == NULL) return; 
-   freeHostList(bucket->list);
-   freeBuckets(bucket->next);
-   free(bucket);
-}
-
 void freeHostListStore(void)
 {
    if(list_store == NULL) return;
    int index;
-   for(index = 0; index < LIST_TABLE_SIZE; index++) freeBuckets(list_store[index]);
+   for(index = 0; index < list_store_slots; index++) 
+   {
+      HostList *list = list_store[index];
+      while(list != NULL)
+      {
+         HostList *next = list->next;
+         freeHostList(list);
+         list = next;
+      }
+   }
    free(list_store);
+   list_store = NULL;
+   list_store_slots = 0;
+   list_store_size = 0;
 }
 #endif
@@ -20,7 +20,7 @@
   ============
 
   Defines data types and operations host labels. Host lists are implemented 
-  as doubly-linked lists, and are stored in a hash table to avoid duplication
+  as contiguous arrays of atoms, and are stored in a hash table to avoid duplication
   of lists that occur multiple times in a graph over the course of a program
   execution.
 
@@ -29,32 +29,37 @@
 #ifndef INC_LABEL_H
 #define INC_LABEL_H
 
-#define LIST_TABLE_SIZE 100003
+/* The initial number of slots of the list and string hash tables. They are
+ * powers of 2. */
+#define LIST_STORE_INITIAL_SIZE 4096
+#define STRING_TABLE_INITIAL_SIZE 4096
 
 #include "common.h"
+#include "pool.h"
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h> 
 #include <stdio.h> 
 #include <string.h> 
 
 typedef enum {NONE = 0, RED, GREEN, BLUE, GREY, DASHED, ANY} MarkType; 
 
+/* A label whose list consists of at most INLINE_LABEL_LENGTH integers is 
+ * stored inline: its list pointer is NULL and the integers are held in 
+ * inline_list. Such lists are always stored inline, so two labels with equal
+ * lists are stored in the same way. The list pointer of the empty label is
+ * also NULL. */
 typedef struct HostLabel {
    MarkType mark;
    int length;
    struct HostList *list;
+   int inline_list[INLINE_LABEL_LENGTH];
 } HostLabel;
 
 extern struct HostLabel blank_label;
 
-typedef struct HostList {
-   int hash;
-   struct HostListItem *first;
-   struct HostListItem *last;
-} HostList;
-
 typedef struct HostAtom {
    char type; /* (i)nteger or (s)tring */
    union {
@@ -63,41 +68,97 @@ typedef struct HostAtom {
    };
 } HostAtom;
 
-typedef struct HostListItem {
-   struct HostAtom atom;
-   struct HostListItem *next;
-   struct HostListItem *prev;
-} HostListItem;
-
-typedef struct Bucket {
-   HostList *list;
+/* String interning. Every string in a host list and every string assigned to a
+ * variable is interned: a single reference-counted copy of each distinct string
+ * is kept in a hash table, along with its length and hash. Two interned strings
+ * are equal if and only if they are the same pointer. 
+ * internString returns the interned copy of the passed string, creating it if
+ * necessary, and takes a reference to it. addInternedString and 
+ * removeInternedString take and drop a reference to an interned string; the 
+ * string is freed when its last reference is dropped. */
+typedef struct InternedString {
+   struct InternedString *next;
+   unsigned int hash;
+   int length;
    int reference_count;
-   struct Bucket *next;
-   struct Bucket *prev;
-} Bucket;
+   char chars[];
+} InternedString;
+
+#define getInternedString(str) \
+   ((InternedString *)((str) - offsetof(InternedString, chars)))
+#define internedLength(str) (getInternedString(str)->length)
+
+string internString(const char *str);
+void addInternedString(string str);
+void removeInternedString(string str);
+void freeStringTable(void);
+
+/* A host list is allocated as a single block holding its length and its atoms,
+ * so that the atoms can be indexed directly from either end. Host lists are
+ * never empty: the empty list is represented by a NULL pointer. 
+ * The hash, reference count and chain pointers are only used if list hashing
+ * is enabled. */
+typedef struct HostList {
+   /* The full hash of the list's contents. Its low bits select the slot of
+    * the list hash table. */
+   unsigned int hash;
+   int length;
+   int reference_count;
+   struct HostList *next;
+   struct HostList *prev;
+   HostAtom atoms[];
+} HostList;
 
 /* Hash table to store lists at runtime. Collisions are handled by separate chaining
- * implemented by singly-linked lists ("buckets" as defined above). Lists are added
+ * implemented by doubly-linked lists threaded through the lists themselves, so
+ * that a list's reference count is reached without searching its slot. Lists are added
  * to the host table by making an array of HostAtoms representing the list and 
  * passing it to makeHostList. In this way, each specific list is allocated to heap
- * exactly once and has a single point of reference. */
-extern Bucket **list_store;
+ * exactly once and has a single point of reference. 
+ * The number of slots is doubled when the table holds more lists than slots,
+ * and halved when it holds fewer than an eighth as many, down to
+ * LIST_STORE_INITIAL_SIZE. */
+extern HostList **list_store;
+
+typedef struct ListStoreStats {
+   int lists;
+   int slots;
+   /* The number of non-empty slots and the length of the longest chain. */
+   int used_slots;
+   int longest_chain;
+} ListStoreStats;
+
+/* Chain length statistics of the list hash table, for profiling. The average
+ * chain length of the non-empty slots is lists / used_slots. */
+ListStoreStats getListStoreStats(void);
+void printListStoreStats(FILE *file);
 
 /* If list hashing is enabled, makeHostList returns a pointer to the HostList represented 
  * by the passed array from the hash table (list_store). If not, the function returns a
  * pointer to a newly-allocated HostList. */
 HostList *makeHostList(HostAtom *array, int length, bool free_strings);
 /* Expects the passed pointer to exist in the list hash table. Increments the reference
- * count of the list's bucket. */
+ * count of the list. */
 void addHostList(HostList *list);
 /* Expects the passed pointer to exist in the list hash table. Decrements the reference
- * count of the list's bucket. Deletes/frees the list and its containing bucket if
- * the new reference count is 0. */
+ * count of the list. Unlinks and frees the list if the new reference count is 0. */
 void removeHostList(HostList *list);
 
-/* Called at runtime to build labels. */
+/* Called at runtime to build labels. makeHostLabel takes over the caller's
+ * reference to the passed list, which it drops if the list is stored inline.
+ * makeHostLabelFromAtoms builds a label from an array of atoms, only calling
+ * makeHostList if the list cannot be stored inline. */
 HostLabel makeEmptyLabel(MarkType mark);
 HostLabel makeHostLabel(MarkType mark, int length, HostList *list);
+HostLabel makeHostLabelFromAtoms(MarkType mark, int length, HostAtom *array,
+                                 bool free_strings);
+
+/* Evaluates to a pointer to the atoms of a host label's list. The atoms of an
+ * inline list are written to the passed buffer, an array of at least
+ * INLINE_LABEL_LENGTH atoms. */
+#define hostLabelAtoms(label, buffer) \
+   ((label).list != NULL ? (label).list->atoms : expandInlineList(&(label), buffer))
+HostAtom *expandInlineList(HostLabel *label, HostAtom *buffer);
 
 /* Used to determine whether a node or edge needs relabelling, and to evaluate
  * the edge predicate if a label argument is provided. */
@@ -109,7 +170,7 @@ bool equalHostLists(HostAtom *left_list, HostAtom *right_list,
 HostList *copyHostList(HostList *list);
 
 void printHostLabel(HostLabel label, FILE *file);
-void printHostList(HostListItem *item, FILE *file);
+void printHostList(HostAtom *atoms, int length, FILE *file);
 
 void freeHostList(HostList *list);
 void freeHostListStore(void);
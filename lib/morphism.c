@@ -24,28 +24,40 @@ Morphism *makeMorphism(int nodes, int edges, int variables)
       exit(1);
    }
    morphism->nodes = nodes;
+   morphism->mapped_node_count = 0;
    if(nodes > 0) 
    {
       morphism->node_map = calloc(nodes, sizeof(Map));
-      if(morphism->node_map == NULL)
+      morphism->mapped_nodes = calloc(nodes, sizeof(int));
+      if(morphism->node_map == NULL || morphism->mapped_nodes == NULL)
       {
          print_to_log("Error (makeMorphism): malloc failure.\n");
          exit(1);
       }
    }
-   else morphism->node_map = NULL;
+   else 
+   {
+      morphism->node_map = NULL;
+      morphism->mapped_nodes = NULL;
+   }
 
    morphism->edges = edges;
+   morphism->mapped_edge_count = 0;
    if(edges > 0) 
    {
       morphism->edge_map = calloc(edges, sizeof(Map));
-      if(morphism->edge_map == NULL)
+      morphism->mapped_edges = calloc(edges, sizeof(int));
+      if(morphism->edge_map == NULL || morphism->mapped_edges == NULL)
       {
          print_to_log("Error (makeMorphism): malloc failure.\n");
          exit(1);
       }
    }
-   else morphism->edge_map = NULL;
+   else 
+   {
+      morphism->edge_map = NULL;
+      morphism->mapped_edges = NULL;
+   }
 
    morphism->variables = variables;
    morphism->variable_index = 0;
@@ -69,48 +81,55 @@ Morphism *makeMorphism(int nodes, int edges, int variables)
       morphism->assignment = NULL;
       morphism->assigned_variables = NULL;
    }
-   initialiseMorphism(morphism, NULL);
+   int index;
+   for(index = 0; index < nodes; index++) morphism->node_map[index].host_index = -1;
+   for(index = 0; index < edges; index++) morphism->edge_map[index].host_index = -1;
+   for(index = 0; index < variables; index++) 
+   {
+      morphism->assignment[index].type = 'n';
+      morphism->assigned_variables[index] = -1;
+   }
    return morphism;
 }
 
 void initialiseMorphism(Morphism *morphism, Graph *graph)
 { 
-   int index;
-   for(index = 0; index < morphism->nodes; index++)
+   if(graph != NULL) resetMatchedFlags(graph);
+   while(morphism->mapped_node_count > 0)
    {
-      if(graph != NULL && morphism->node_map[index].host_index >= 0)
-         resetMatchedNodeFlag(graph, morphism->node_map[index].host_index);
+      int index = morphism->mapped_nodes[--morphism->mapped_node_count];
       morphism->node_map[index].host_index = -1;
       morphism->node_map[index].assignments = 0;
    }
-   for(index = 0; index < morphism->edges; index++)
+   while(morphism->mapped_edge_count > 0)
    {
-      if(graph != NULL && morphism->edge_map[index].host_index >= 0)
-         resetMatchedEdgeFlag(graph, morphism->edge_map[index].host_index);
+      int index = morphism->mapped_edges[--morphism->mapped_edge_count];
       morphism->edge_map[index].host_index = -1;
       morphism->edge_map[index].assignments = 0;
    }
-   morphism->variable_index = 0;
-   for(index = 0; index < morphism->variables; index++)
+   /* Every assigned variable is on the assigned_variables stack. */
+   while(morphism->variable_index > 0)
    {
-      if(morphism->assignment[index].type == 's')
+      int id = popVariableId(morphism);
+      if(morphism->assignment[id].type == 's')
       {
-         free(morphism->assignment[index].str);
-         morphism->assignment[index].str = NULL;
+         removeInternedString(morphism->assignment[id].str);
+         morphism->assignment[id].str = NULL;
       }
-      if(morphism->assignment[index].type == 'l')
+      if(morphism->assignment[id].type == 'l')
       {
-         removeHostList(morphism->assignment[index].list);
-         morphism->assignment[index].list = NULL;
+         removeHostList(morphism->assignment[id].list);
+         morphism->assignment[id].list = NULL;
       }
-      morphism->assignment[index].type = 'n';
-      morphism->assigned_variables[index] = -1;
+      morphism->assignment[id].type = 'n';
    }
 }
 
 void addNodeMap(Morphism *morphism, int left_index, int host_index, int assignments)
 {
    assert(left_index < morphism->nodes);
+   if(morphism->node_map[left_index].host_index < 0)
+      morphism->mapped_nodes[morphism->mapped_node_count++] = left_index;
    morphism->node_map[left_index].host_index = host_index;
    morphism->node_map[left_index].assignments = assignments;
 }
@@ -118,33 +137,63 @@ void addNodeMap(Morphism *morphism, int left_index, int host_index, int assignme
 void addEdgeMap(Morphism *morphism, int left_index, int host_index, int assignments)
 {
    assert(left_index < morphism->edges);
+   if(morphism->edge_map[left_index].host_index < 0)
+      morphism->mapped_edges[morphism->mapped_edge_count++] = left_index;
    morphism->edge_map[left_index].host_index = host_index;
    morphism->edge_map[left_index].assignments = assignments;
 }
 
 int addListAssignment(Morphism *morphism, int id, HostList *list) 
+{
+   if(list == NULL)
+   {
+      assert(id < morphism->variables);
+      Assignment *assignment = &(morphism->assignment[id]);
+      if(assignment->type == 'n')
+      {
+         assignment->type = 'l';
+         assignment->list = NULL;
+         assignment->start = 0;
+         assignment->length = 0;
+         pushVariableId(morphism, id);
+         return 1;
+      }
+      if(assignment->type == 'l' && assignment->length == 0) return 0;
+      else return -1;
+   }
+   return addSublistAssignment(morphism, id, list, 0, list->length);
+}
+
+int addSublistAssignment(Morphism *morphism, int id, HostList *list, int start,
+                         int length)
 {
    /* Search the morphism for an existing assignment to the passed variable. */
    assert(id < morphism->variables);
-   if(morphism->assignment[id].type == 'n') 
+   Assignment *assignment = &(morphism->assignment[id]);
+   if(assignment->type == 'n') 
    {
-      morphism->assignment[id].type = 'l';
+      assignment->type = 'l';
+      /* With list hashing, the assignment keeps a reference to the whole list.
+       * Otherwise it keeps its own copy of the sublist. */
       #ifdef LIST_HASHING
          addHostList(list);
-         morphism->assignment[id].list = list;
+         assignment->list = list;
+         assignment->start = start;
       #else
-         HostList *list_copy = copyHostList(list);
-         morphism->assignment[id].list = list_copy;
+         assignment->list = makeHostList(list->atoms + start, length, false);
+         assignment->start = 0;
       #endif
+      assignment->length = length;
       pushVariableId(morphism, id);
       return 1;
    }
    /* Compare the list in the assignment to the list passed to the function. */
-   else 
-   {
-      if(morphism->assignment[id].list == list) return 0;
-      else return -1;
-   }
+   if(assignment->type != 'l' || assignment->length != length) return -1;
+   if(length == 0) return 0;
+   if(assignment->list == list && assignment->start == start) return 0;
+   if(equalHostLists(assignmentAtoms(*assignment), list->atoms + start, length, length))
+      return 0;
+   else return -1;
 }
 
 int addIntegerAssignment(Morphism *morphism, int id, int num)
@@ -159,7 +208,8 @@ int addIntegerAssignment(Morphism *morphism, int id, int num)
    }
    else
    {
-      if(morphism->assignment[id].num == num) return 0;
+      if(morphism->assignment[id].type == 'i' && morphism->assignment[id].num == num) 
+         return 0;
       else return -1;
    }
 }
@@ -170,19 +220,43 @@ int addStringAssignment(Morphism *morphism, int id, string str)
    if(morphism->assignment[id].type == 'n') 
    {
       morphism->assignment[id].type = 's';
-      morphism->assignment[id].str = strdup(str);
+      addInternedString(str);
+      morphism->assignment[id].str = str;
+      pushVariableId(morphism, id);
+      return 1;
+   }
+   /* Interned strings are equal if and only if they are the same pointer. */
+   else
+   {
+      if(morphism->assignment[id].type == 's' && morphism->assignment[id].str == str) 
+         return 0;
+      else return -1;
+   }
+}
+
+int addSubstringAssignment(Morphism *morphism, int id, const char *str)
+{
+   assert(id < morphism->variables);
+   if(morphism->assignment[id].type == 'n') 
+   {
+      morphism->assignment[id].type = 's';
+      morphism->assignment[id].str = internString(str);
       pushVariableId(morphism, id);
       return 1;
    }
    else
    {
-      if(strcmp(morphism->assignment[id].str, str) == 0) return 0;
+      if(morphism->assignment[id].type == 's' && 
+         strcmp(morphism->assignment[id].str, str) == 0) return 0;
       else return -1;
    }
 }
 
 void removeNodeMap(Morphism *morphism, int left_index)
 {
+   assert(morphism->mapped_node_count > 0 && 
+          morphism->mapped_nodes[morphism->mapped_node_count - 1] == left_index);
+   morphism->mapped_node_count--;
    morphism->node_map[left_index].host_index = -1;
    removeAssignments(morphism, morphism->node_map[left_index].assignments);
    morphism->node_map[left_index].assignments = 0;
@@ -190,6 +264,9 @@ void removeNodeMap(Morphism *morphism, int left_index)
 
 void removeEdgeMap(Morphism *morphism, int left_index)
 {
+   assert(morphism->mapped_edge_count > 0 && 
+          morphism->mapped_edges[morphism->mapped_edge_count - 1] == left_index);
+   morphism->mapped_edge_count--;
    morphism->edge_map[left_index].host_index = -1;
    removeAssignments(morphism, morphism->edge_map[left_index].assignments);
    morphism->edge_map[left_index].assignments = 0;
@@ -203,7 +280,7 @@ void removeAssignments(Morphism *morphism, int number)
       int id = popVariableId(morphism);
       if(morphism->assignment[id].type == 's')
       {
-         free(morphism->assignment[id].str);
+         removeInternedString(morphism->assignment[id].str);
          morphism->assignment[id].str = NULL;
       }
       if(morphism->assignment[id].type == 'l')
@@ -259,15 +336,7 @@ Assignment getAssignment(Morphism *morphism, int id)
 int getAssignmentLength(Assignment assignment)
 {
    if(assignment.type != 'l') return 1;
-   if(assignment.list == NULL) return 0;
-   HostListItem *item = assignment.list->first;
-   int length = 0;
-   while(item != NULL) 
-   {
-      length++;
-      item = item->next;
-   }
-   return length;
+   return assignment.length;
 }
 
 /* If rule_string is a prefix of host_string, return the position in host_string
@@ -330,8 +399,9 @@ void printMorphism(Morphism *morphism)
            printf("\"%s\"", morphism->assignment[index].str);
          if(morphism->assignment[index].type == 'l')
          {
-            if(morphism->assignment[index].list == NULL) printf("empty");
-            else printHostList(morphism->assignment[index].list->first, stdout);
+            if(morphism->assignment[index].length == 0) printf("empty");
+            else printHostList(assignmentAtoms(morphism->assignment[index]), 
+                               morphism->assignment[index].length, stdout);
          }
          printf("\n\n");
       }
@@ -343,13 +413,15 @@ void freeMorphism(Morphism *morphism)
    if(morphism == NULL) return;
    if(morphism->node_map != NULL) free(morphism->node_map);
    if(morphism->edge_map != NULL) free(morphism->edge_map);
+   if(morphism->mapped_nodes != NULL) free(morphism->mapped_nodes);
+   if(morphism->mapped_edges != NULL) free(morphism->mapped_edges);
    if(morphism->assignment != NULL)
    {
       int index;
       for(index = 0; index < morphism->variables; index++)
       {
          if(morphism->assignment[index].type == 's') 
-            free(morphism->assignment[index].str);
+            removeInternedString(morphism->assignment[index].str);
          #ifdef LIST_HASHING
             if(morphism->assignment[index].type == 'l')
                removeHostList(morphism->assignment[index].list);
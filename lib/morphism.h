@@ -39,6 +39,10 @@
 #include <stdio.h> 
 #include <string.h> 
 
+/* The value of a list assignment is the sublist of 'list' of the given length
+ * starting at index 'start'. A list variable matched to part of a host list
+ * thereby shares the host list, and its value is never interned. The empty
+ * list is represented by a NULL list and length 0. */
 typedef struct Assignment {
    char type; /* (n)ot assigned, (i)nteger, (s)tring, (l)ist */
    union {
@@ -46,8 +50,13 @@ typedef struct Assignment {
       string str;
       struct HostList *list;
    };
+   int start;
+   int length;
 } Assignment;
 
+/* The atoms of the value of a list assignment with a non-NULL list. */
+#define assignmentAtoms(assignment) ((assignment).list->atoms + (assignment).start)
+
 typedef struct Map {
    int host_index;
    /* The number of variable-value assignments added by this node map.
@@ -73,16 +82,40 @@ typedef struct Morphism {
    /* Stack to record the order of variable assignments during rule matching. */
    int *assigned_variables;
    int variable_index;
+
+   /* Stacks of the left indices of the node and edge maps that are currently
+    * set. Maps are added and removed in LIFO order during matching, so each 
+    * stack holds at most one entry per map. initialiseMorphism only resets the
+    * maps and assignments on the stacks. */
+   int *mapped_nodes;
+   int mapped_node_count;
+   int *mapped_edges;
+   int mapped_edge_count;
 } Morphism;
 
+/* The type of the callbacks passed to the forEachMatch<Rule> function generated
+ * for each rule. forEachMatch<Rule> searches for matches of the rule in the 
+ * host graph in the same order as match<Rule>, and calls the callback with
+ * each complete match in the morphism. The callback must not modify the host
+ * graph or the morphism. It returns true to stop the search, leaving the 
+ * match in the morphism as match<Rule> does (the morphism of a rule only used
+ * as a predicate is reset), or false to continue the search with the next
+ * match. forEachMatch<Rule> returns true if the search was
+ * stopped by the callback, and false once all matches have been reported, in
+ * which case the morphism has been reset. */
+typedef bool (*MatchCallback)(Morphism *morphism, void *data);
+
 /* Allocates memory for the morphism, and calls initialiseMorphism. */
 Morphism *makeMorphism(int nodes, int edges, int variables);
 
 /* This function is used to both initialise the morphism on creation and to 
  * reset the morphism after each rule application. The data in the morphism
- * are reset to their default values. 
+ * are reset to their default values. Only the maps and assignments that have
+ * been set are visited, so resetting a morphism after a match that failed
+ * early costs almost nothing. 
  * The host graph is passed as an optional second argument to reset the matched flags
- * of all host graph items matched by the morphism. */
+ * of the host graph items. This starts a new match epoch in the host graph, so it
+ * takes constant time. */
 void initialiseMorphism(Morphism *morphism, Graph *graph);
 void addNodeMap(Morphism *morphism, int left_index, int host_index, int assignments);
 void removeNodeMap(Morphism *morphism, int left_index);
@@ -99,8 +132,18 @@ void removeEdgeMap(Morphism *morphism, int left_index);
  * the passed value.
  * Returns 1 if the variable did not previously exist in the assignment. */
 int addListAssignment(Morphism *morphism, int id, HostList *list);
+/* Assigns the sublist of the passed list of the given length starting at
+ * index start. The list must not be NULL. */
+int addSublistAssignment(Morphism *morphism, int id, HostList *list, int start,
+                         int length);
 int addIntegerAssignment(Morphism *morphism, int id, int num);
+/* addStringAssignment expects an interned string, such as a string atom of a
+ * host list. The assignment takes a reference to it, so binding a host string
+ * neither hashes nor allocates. addSubstringAssignment is used for strings 
+ * built during matching, which are compared by content and only interned when
+ * they become the value of the variable. */
 int addStringAssignment(Morphism *morphism, int id, string value);
+int addSubstringAssignment(Morphism *morphism, int id, const char *value);
 
 void removeAssignments(Morphism *morphism, int number);
 void pushVariableId(Morphism *morphism, int id);
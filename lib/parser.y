@@ -43,8 +43,36 @@ int yylex(void);
 
 /* Declarations of global variables placed at the bottom of hostParser.h. */ 
  %code provides {
+/* Maps the node IDs of the host graph file to the indices of the nodes in the
+ * host graph. IDs no larger than a small multiple of the number of nodes are
+ * mapped by a dense array indexed by ID. Sparse IDs are mapped by an open
+ * addressing hash table of (ID, index) pairs. */
+typedef struct NodeIDMap {
+   bool dense;
+   int size;
+   int capacity;
+   /* Unused in the dense map. In the hash table, -1 marks an empty slot. */
+   int *ids;
+   /* -1 marks an unmapped ID in the dense map. */
+   int *indices;
+} NodeIDMap;
+
+/* The arguments are the expected number of nodes and the largest node ID, which
+ * are obtained by countHostGraphItems. The map grows if they are exceeded. */
+NodeIDMap *makeNodeIDMap(int nodes, int max_node_id);
+void addToNodeIDMap(NodeIDMap *map, int id, int index);
+/* Returns -1 if the ID is not mapped. */
+int lookupNodeID(NodeIDMap *map, int id);
+void freeNodeIDMap(NodeIDMap *map);
+
+/* A fast pass over a host graph file before parsing. Counts the nodes and edges
+ * and finds the largest node ID, so that the host graph and the node ID map
+ * can be allocated at their final size. The file is rewound afterwards. The
+ * counts are estimates if the file is malformed; the parser reports errors. */
+void countHostGraphItems(FILE *file, int *nodes, int *edges, int *max_node_id);
+
 extern struct Graph *host;
-extern int *node_map;
+extern NodeIDMap *node_map;
 extern string yytext;
 extern FILE *yyin;
 }
@@ -61,7 +89,6 @@ int length = 0;
 
 /* Temporary automatic storage for host lists before they are added to the list hashtable. */
 HostAtom array[64];
-HostList *host_list = NULL;
 %}
 
 %locations /* Generates code to process locations of symbols in the source file. */
@@ -105,10 +132,11 @@ HostGraph: '[' '|' ']'  		{ }
 HostNodeList: HostNode			{ }
             | HostNodeList HostNode	{ }
 
-HostNode: '(' NodeID RootNode ',' HostLabel ')' { node_map[$2] = addNode(host, is_root, $5); 
- 				   	          is_root = false; } 
+HostNode: '(' NodeID RootNode ',' HostLabel ')' 
+					{ addToNodeIDMap(node_map, $2, addNode(host, is_root, $5)); 
+ 				   	  is_root = false; } 
         | '(' NodeID RootNode ',' HostLabel Position ')'
-    					{ node_map[$2] = addNode(host, is_root, $5); 
+    					{ addToNodeIDMap(node_map, $2, addNode(host, is_root, $5)); 
  					  is_root = false; } 
 
 RootNode: /* empty */ 
@@ -129,25 +157,29 @@ HostEdgeList: HostEdge			{ }
             | HostEdgeList HostEdge	{ } 
 
 HostEdge: '(' EdgeID ',' NodeID ',' NodeID ',' HostLabel ')'
-					{ addEdge(host, $8, node_map[$4], node_map[$6]); }
+					{ int source = lookupNodeID(node_map, $4);
+					  int target = lookupNodeID(node_map, $6);
+					  if(source < 0 || target < 0)
+					  {
+					     yyerror("Edge incident to an undefined node");
+					     removeHostList($8.list);
+					     YYABORT;
+					  }
+					  addEdge(host, $8, source, target); }
 
 NodeID:  NUM				/* default $$ = $1 */
 EdgeID:  NUM				/* default $$ = $1 */
 
 HostLabel: HostList			{ if(length == 0) $$ = blank_label;	
 				          else {
-					     host_list = makeHostList(array, length, true);
-					     $$ = makeHostLabel(NONE, length, host_list); 
+					     $$ = makeHostLabelFromAtoms(NONE, length, array, true); 
 					     length = 0;
-					     host_list = NULL; 
 					  }
 	  				}
          | HostList '#' MARK	  	{ if(length == 0) $$ = makeEmptyLabel($3); 
 	 			          else {
-					     host_list = makeHostList(array, length, true); 
-                                             $$ = makeHostLabel($3, length, host_list); 
+                                             $$ = makeHostLabelFromAtoms($3, length, array, true); 
 					     length = 0;
-					     host_list = NULL;
 					  }
 					}
 
@@ -175,3 +207,201 @@ void yyerror(const char *error_message)
 }
 
   
+
+/* Node IDs up to DENSE_ID_FACTOR times the number of nodes (plus a constant for
+ * small graphs) are mapped by a dense array. */
+#define DENSE_ID_FACTOR 4
+#define DENSE_ID_SLACK 1024
+
+static bool denseIDs(int nodes, int max_node_id)
+{
+   return max_node_id < DENSE_ID_FACTOR * (long)nodes + DENSE_ID_SLACK;
+}
+
+static int *makeIDArray(int capacity)
+{
+   int *array = malloc(capacity * sizeof(int)), index;
+   if(array == NULL)
+   {
+      print_to_log("Error (makeNodeIDMap): malloc failure.\n");
+      exit(1);
+   }
+   for(index = 0; index < capacity; index++) array[index] = -1;
+   return array;
+}
+
+NodeIDMap *makeNodeIDMap(int nodes, int max_node_id)
+{
+   NodeIDMap *map = malloc(sizeof(NodeIDMap));
+   if(map == NULL)
+   {
+      print_to_log("Error (makeNodeIDMap): malloc failure.\n");
+      exit(1);
+   }
+   map->size = 0;
+   map->dense = denseIDs(nodes, max_node_id);
+   if(map->dense)
+   {
+      map->capacity = max_node_id < 16 ? 16 : max_node_id + 1;
+      map->ids = NULL;
+   }
+   else
+   {
+      /* The table is kept at most half full. */
+      map->capacity = 16;
+      while(map->capacity < 2 * nodes) map->capacity *= 2;
+      map->ids = makeIDArray(map->capacity);
+   }
+   map->indices = makeIDArray(map->capacity);
+   return map;
+}
+
+static unsigned int hashNodeID(int id, int capacity)
+{
+   /* Fibonacci hashing. The capacity of the table is a power of 2. */
+   return ((unsigned int)id * 2654435769u) & (capacity - 1);
+}
+
+static void insertNodeID(NodeIDMap *map, int id, int index)
+{
+   unsigned int slot = hashNodeID(id, map->capacity);
+   while(map->ids[slot] >= 0 && map->ids[slot] != id) 
+      slot = (slot + 1) & (map->capacity - 1);
+   if(map->ids[slot] < 0) map->size++;
+   map->ids[slot] = id;
+   map->indices[slot] = index;
+}
+
+/* Rebuilds the map as a hash table with the given capacity. This is called when
+ * the hash table fills up or when an ID too large for the dense array occurs. */
+static void rehashNodeIDMap(NodeIDMap *map, int capacity)
+{
+   int old_capacity = map->capacity, index;
+   int *old_ids = map->ids, *old_indices = map->indices;
+   bool was_dense = map->dense;
+   map->dense = false;
+   map->size = 0;
+   map->capacity = capacity;
+   map->ids = makeIDArray(capacity);
+   map->indices = makeIDArray(capacity);
+   for(index = 0; index < old_capacity; index++)
+   {
+      if(was_dense && old_indices[index] >= 0) insertNodeID(map, index, old_indices[index]);
+      else if(!was_dense && old_ids[index] >= 0) 
+         insertNodeID(map, old_ids[index], old_indices[index]);
+   }
+   if(old_ids != NULL) free(old_ids);
+   free(old_indices);
+}
+
+void addToNodeIDMap(NodeIDMap *map, int id, int index)
+{
+   if(map->dense)
+   {
+      if(id >= map->capacity)
+      {
+         if(!denseIDs(map->size + 1, id))
+         {
+            int capacity = 16;
+            while(capacity < 2 * (map->size + 1)) capacity *= 2;
+            rehashNodeIDMap(map, capacity);
+            addToNodeIDMap(map, id, index);
+            return;
+         }
+         int old_capacity = map->capacity, slot;
+         map->capacity = id >= 2 * old_capacity ? id + 1 : 2 * old_capacity;
+         map->indices = realloc(map->indices, map->capacity * sizeof(int));
+         if(map->indices == NULL)
+         {
+            print_to_log("Error (addToNodeIDMap): malloc failure.\n");
+            exit(1);
+         }
+         for(slot = old_capacity; slot < map->capacity; slot++) map->indices[slot] = -1;
+      }
+      if(map->indices[id] < 0) map->size++;
+      map->indices[id] = index;
+   }
+   else
+   {
+      if(2 * (map->size + 1) > map->capacity) rehashNodeIDMap(map, 2 * map->capacity);
+      insertNodeID(map, id, index);
+   }
+}
+
+int lookupNodeID(NodeIDMap *map, int id)
+{
+   if(map->dense) return id < map->capacity ? map->indices[id] : -1;
+   unsigned int slot = hashNodeID(id, map->capacity);
+   while(map->ids[slot] >= 0)
+   {
+      if(map->ids[slot] == id) return map->indices[slot];
+      slot = (slot + 1) & (map->capacity - 1);
+   }
+   return -1;
+}
+
+void freeNodeIDMap(NodeIDMap *map)
+{
+   if(map == NULL) return;
+   if(map->ids != NULL) free(map->ids);
+   free(map->indices);
+   free(map);
+}
+
+/* Host graph files have the form [ <position> | nodes | edges ], where the
+ * position is optional. Every node and edge is enclosed in parentheses at the
+ * top level of the graph; other parentheses, such as those of the root marker
+ * "(R)", are nested. The items before the last top-level '|' are nodes and 
+ * those after it are edges. String literals and comments are skipped. */
+void countHostGraphItems(FILE *file, int *nodes, int *edges, int *max_node_id)
+{
+   int c, depth = 0, items = 0, section_max_id = -1;
+   bool read_id = false;
+   *nodes = 0;
+   *max_node_id = -1;
+   while((c = fgetc(file)) != EOF)
+   {
+      if(c == '"')
+      {
+         while((c = fgetc(file)) != EOF && c != '"' && c != '\n');
+         continue;
+      }
+      if(c == '/')
+      {
+         if((c = fgetc(file)) == '/') while((c = fgetc(file)) != EOF && c != '\n');
+         else ungetc(c, file);
+         continue;
+      }
+      /* The item ID directly follows the opening parenthesis. */
+      if(read_id)
+      {
+         if(c >= '0' && c <= '9')
+         {
+            int id = c - '0';
+            while((c = fgetc(file)) >= '0' && c <= '9') id = 10 * id + (c - '0');
+            if(id > section_max_id) section_max_id = id;
+            read_id = false;
+            if(c == EOF) break;
+         }
+         else if(c != ' ' && c != '\t' && c != '\r' && c != '\n') read_id = false;
+      }
+      if(c == '(')
+      {
+         if(depth++ == 0) 
+         {
+            items++;
+            read_id = true;
+         }
+      }
+      else if(c == ')' && depth > 0) depth--;
+      else if(c == '|' && depth == 0)
+      {
+         *nodes += items;
+         if(section_max_id > *max_node_id) *max_node_id = section_max_id;
+         items = 0;
+         section_max_id = -1;
+      }
+   }
+   *edges = items;
+   rewind(file);
+}
@@ -0,0 +1,112 @@
+/* Copyright 2015-2017 Christopher Bak
+
+  This file is part of the GP 2 Compiler. The GP 2 Compiler is free software: 
+  you can redistribute it and/or modify it under the terms of the GNU General
+  Public License as published by the Free Software Foundation, either version 3
+  of the License, or (at your option) any later version.
+
+  The GP 2 Compiler is distributed in the hope that it will be useful, but 
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY 
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for 
+  more details.
+
+  You should have received a copy of the GNU General Public License
+  along with the GP 2 Compiler. If not, see <http://www.gnu.org/licenses/>. */
+
+#include "pool.h"
+
+#ifdef POOL_ALLOCATION
+/* A freed block holds the link to the next free block of its size class. */
+typedef struct FreeBlock {
+   struct FreeBlock *next;
+} FreeBlock;
+
+/* The slabs are chained through their first POOL_GRANULARITY bytes, which keeps
+ * the blocks carved from the rest of the slab aligned. */
+typedef struct Slab {
+   struct Slab *next;
+} Slab;
+
+static FreeBlock *free_blocks[POOL_SIZE_CLASSES] = {NULL};
+static Slab *slabs = NULL;
+/* The unused part of the most recently allocated slab. */
+static char *slab_top = NULL;
+static char *slab_end = NULL;
+
+static void newSlab(void)
+{
+   Slab *slab = malloc(POOL_SLAB_SIZE);
+   if(slab == NULL)
+   {
+      print_to_log("Error (newSlab): malloc failure.\n");
+      exit(1);
+   }
+   slab->next = slabs;
+   slabs = slab;
+   slab_top = (char*)slab + POOL_GRANULARITY;
+   slab_end = (char*)slab + POOL_SLAB_SIZE;
+}
+#endif
+
+void *poolAlloc(size_t size)
+{
+   #ifdef POOL_ALLOCATION
+      if(size > 0 && size <= POOL_GRANULARITY * POOL_SIZE_CLASSES)
+      {
+         int size_class = (size - 1) / POOL_GRANULARITY;
+         FreeBlock *block = free_blocks[size_class];
+         if(block != NULL)
+         {
+            free_blocks[size_class] = block->next;
+            return block;
+         }
+         size_t block_size = (size_class + 1) * POOL_GRANULARITY;
+         if(slab_top == NULL || (size_t)(slab_end - slab_top) < block_size) newSlab();
+         void *new_block = slab_top;
+         slab_top += block_size;
+         return new_block;
+      }
+   #endif
+   void *block = malloc(size);
+   if(block == NULL)
+   {
+      print_to_log("Error (poolAlloc): malloc failure.\n");
+      exit(1);
+   }
+   return block;
+}
+
+void poolFree(void *block, size_t size)
+{
+   if(block == NULL) return;
+   #ifdef POOL_ALLOCATION
+      if(size > 0 && size <= POOL_GRANULARITY * POOL_SIZE_CLASSES)
+      {
+         int size_class = (size - 1) / POOL_GRANULARITY;
+         FreeBlock *free_block = block;
+         free_block->next = free_blocks[size_class];
+         free_blocks[size_class] = free_block;
+         return;
+      }
+   #else
+      (void)size;
+   #endif
+   free(block);
+}
+
+void freePools(void)
+{
+   #ifdef POOL_ALLOCATION
+      while(slabs != NULL)
+      {
+         Slab *next = slabs->next;
+         free(slabs);
+         slabs = next;
+      }
+      int size_class;
+      for(size_class = 0; size_class < POOL_SIZE_CLASSES; size_class++)
+         free_blocks[size_class] = NULL;
+      slab_top = NULL;
+      slab_end = NULL;
+   #endif
+}
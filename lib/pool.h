@@ -0,0 +1,50 @@
+/* ///////////////////////////////////////////////////////////////////////////
+
+  Copyright 2015-2017 Christopher Bak
+
+  This file is part of the GP 2 Compiler. The GP 2 Compiler is free software:
+  you can redistribute it and/or modify it under the terms of the GNU General
+  Public License as published by the Free Software Foundation, either version 3
+  of the License, or (at your option) any later version.
+
+  The GP 2 Compiler is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+  more details.
+
+  You should have received a copy of the GNU General Public License
+  along with the GP 2 Compiler. If not, see <http://www.gnu.org/licenses/>.
+
+  ===========
+  Pool Module
+  ===========
+
+  A size-class pool allocator for the small blocks that are allocated and
+  freed at a high rate at runtime: host lists and interned strings. Block
+  sizes are rounded up to a multiple of POOL_GRANULARITY. Blocks of each size
+  class are carved from large slabs, and freed blocks are kept on a free list
+  of their size class to be reused. Blocks larger than the largest size class
+  are allocated with malloc. The slabs are released in bulk by freePools at
+  the end of the program.
+
+/////////////////////////////////////////////////////////////////////////// */
+
+#ifndef INC_POOL_H
+#define INC_POOL_H
+
+#define POOL_GRANULARITY 16
+#define POOL_SIZE_CLASSES 16
+#define POOL_SLAB_SIZE 65536
+
+#include "common.h"
+
+#include <stdlib.h>
+
+/* The caller passes the size of the block to poolFree, which must be the size
+ * passed to poolAlloc when the block was allocated. */
+void *poolAlloc(size_t size);
+void poolFree(void *block, size_t size);
+/* Releases all slabs. Every pooled block is invalid afterwards. */
+void freePools(void);
+
+#endif /* INC_POOL_H */
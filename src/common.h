@@ -31,6 +31,10 @@
  * reference. Otherwise, nodes and edges point to their own copies of their list. */
 #define LIST_HASHING
 
+/* Host labels whose list consists of at most this many integers are stored in
+ * the label itself by the runtime library. Must agree with lib/common.h. */
+#define INLINE_LABEL_LENGTH 2
+
 #define print_to_log(error_message, ...)                    \
   do { fprintf(log_file, error_message, ##__VA_ARGS__); }   \
   while(0)
@@ -73,6 +77,11 @@ typedef enum {INTEGER_VAR = 0, CHARACTER_VAR, STRING_VAR, ATOM_VAR, LIST_VAR} GP
 
 typedef enum {NONE = 0, RED, GREEN, BLUE, GREY, DASHED, ANY} MarkType; 
 
+/* Host label classes. This must match the LabelClass enum in lib/graph.h. */
+#define NUMBER_OF_CLASSES 7
+typedef enum {EMPTY_L = 0, INT_L, STRING_L, LIST2_L, LIST3_L, LIST4_L, 
+              LONG_LIST_L} LabelClass;
+
 typedef enum {INT_CHECK = 0, CHAR_CHECK, STRING_CHECK, ATOM_CHECK, EDGE_PRED,
               EQUAL, NOT_EQUAL, GREATER, GREATER_EQUAL, LESS, LESS_EQUAL, 
               BOOL_NOT, BOOL_OR, BOOL_AND } ConditionType;
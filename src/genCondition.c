@@ -225,49 +225,42 @@ static void generatePredicateCode(Rule *rule, Predicate *predicate)
       {
            int source = predicate->edge_pred.source;    
            int target = predicate->edge_pred.target;    
-           PTFI("Node *source = getNode(host, n%d);\n", 3, source);
+           if(predicate->edge_pred.label.length < 0)
+           {
+              PTFI("b%d = firstEdgeBetween(host, n%d, n%d) >= 0;\n", 3,
+                   predicate->bool_id, source, target);
+              break;
+           }
            PTFI("bool edge_found = false;\n", 3);
-           PTFI("int counter;\n", 3);
-           PTFI("for(counter = 0; counter < source->out_edges.size + 2; counter++)\n", 3);
+           PTFI("int host_index;\n", 3);
+           PTFI("for(host_index = firstEdgeBetween(host, n%d, n%d); host_index >= 0;\n", 3,
+                source, target);
+           PTFI("    host_index = nextEdgeBetween(host, host_index))\n", 3);
            PTFI("{\n", 3);
-           PTFI("Edge *edge = getNthOutEdge(host, source, counter);\n", 6);
-           PTFI("if(edge != NULL && edge->target == n%d)\n", 6, target);
-           if(predicate->edge_pred.label.length >= 0)
-           { 
-              PTFI("{\n", 6);
-              PTFI("HostLabel label;\n", 9);
-              /* Create runtime variables for each variable in the label. */
-              RuleListItem *item = predicate->edge_pred.label.list->first;
-              int count;
-              for(count = 0; count < predicate->edge_pred.label.length; count++)
+           PTFI("Edge *edge = getEdge(host, host_index);\n", 6);
+           PTFI("HostLabel label;\n", 6);
+           /* Create runtime variables for each variable in the label. */
+           RuleListItem *item = predicate->edge_pred.label.list->first;
+           int count;
+           for(count = 0; count < predicate->edge_pred.label.length; count++)
+           {
+              if(item->atom->type == VARIABLE)
               {
-                 if(item->atom->type == VARIABLE)
-                 {
-                    /* generateVariableCode prints with indent 3. Indent of 9 is required. */
-                    PTF("      ");
-                    generateVariableCode(count, item->atom->variable.type);
-                 }
-                 item = item->next;
+                 /* generateVariableCode prints with indent 3. Indent of 6 is required. */
+                 PTF("   ");
+                 generateVariableCode(count, item->atom->variable.type);
               }
-              generateLabelEvaluationCode(predicate->edge_pred.label, false, list_count++, 1, 9);
-              PTFI("if(equalHostLabels(label, edge->label))\n", 9);
-              PTFI("{\n", 9);
-              PTFI("b%d = true;\n", 12, predicate->bool_id);
-              PTFI("edge_found = true;\n", 12);
-              PTFI("removeHostList(label.list);\n", 12);
-              PTFI("break;\n", 12);
-              PTFI("}\n", 9);
-              PTFI("removeHostList(label.list);\n", 9);
-              PTFI("}\n", 6);
-           }
-           else
-           {
-              PTFI("{\n", 6);
-              PTFI("b%d = true;\n", 9, predicate->bool_id);
-              PTFI("edge_found = true;\n", 9);
-              PTFI("break;\n", 9);
-              PTFI("}\n", 6);
+              item = item->next;
            }
+           generateLabelEvaluationCode(predicate->edge_pred.label, false, list_count++, 1, 6);
+           PTFI("if(equalHostLabels(label, edge->label))\n", 6);
+           PTFI("{\n", 6);
+           PTFI("b%d = true;\n", 9, predicate->bool_id);
+           PTFI("edge_found = true;\n", 9);
+           PTFI("removeHostList(label.list);\n", 9);
+           PTFI("break;\n", 9);
+           PTFI("}\n", 6);
+           PTFI("removeHostList(label.list);\n", 6);
            PTFI("}\n", 3);
            PTFI("if(!edge_found) b%d = false;\n", 3, predicate->bool_id);
            break;
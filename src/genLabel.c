@@ -36,6 +36,10 @@ static void generateStringMatchingCode(Rule *rule, StringList *string_exp,
                                        bool prefix, int indent);
 static void generateStringLengthCode(RuleAtom *atom, int indent);
 static void generateStringExpression(RuleAtom *atom, bool first, int indent);
+static bool constantLabel(RuleLabel label);
+static bool inlineConstantLabel(RuleLabel label);
+static int generateConstantListCode(RuleLabel label, int indent);
+static void generateConstantLabelCode(RuleLabel label, bool node, int indent);
 
 StringList *appendStringExp(StringList *list, int type, string constant, int id)
 {
@@ -119,6 +123,12 @@ void freeStringList(StringList *list)
  * declared at most once per label at runtime. */
 bool result_declared = false;
 
+/* Used to name the static variables holding interned string constants. */
+static int string_constant_count = 0;
+
+/* Used to name the static variables holding interned constant lists. */
+static int constant_list_count = 0;
+
 void generateFixedListMatchingCode(Rule *rule, RuleLabel label, int indent)
 {
    PTFI("/* Label Matching */\n", indent);
@@ -130,6 +140,27 @@ void generateFixedListMatchingCode(Rule *rule, RuleLabel label, int indent)
       PTFI("match = label.length == 0 ? true : false;\n", indent);
       return;
    }
+   /* A short list of integer constants is matched by comparing the integers 
+    * stored inline in the host label. */
+   else if(inlineConstantLabel(label))
+   {
+      PTFI("match = label.list == NULL && label.length == %d", indent, label.length);
+      int index = 0;
+      RuleListItem *item;
+      for(item = label.list->first; item != NULL; item = item->next)
+         PTF(" &&\n%*slabel.inline_list[%d] == %d", indent + 8, " ", index++, 
+             item->atom->number);
+      PTF(";\n");
+   }
+   #ifdef LIST_HASHING
+      /* Equal lists are the same pointer in the list store, so a constant list
+       * is matched by comparing the host list with the interned constant. */
+      else if(constantLabel(label))
+      {
+         int count = generateConstantListCode(label, indent);
+         PTFI("match = label.list == constant_list%d;\n", indent, count);
+      }
+   #endif
    else
    {
       /* A do-while loop is generated so that the label matching code can be exited
@@ -143,14 +174,16 @@ void generateFixedListMatchingCode(Rule *rule, RuleLabel label, int indent)
       /* Lists without list variables admit relatively simple code generation as each
       * rule atom maps directly to the host atom in the same position. */
       RuleListItem *item = label.list->first;
-      PTFI("HostListItem *item = label.list->first;\n", indent + 3);
+      PTFI("HostAtom inline_atoms[INLINE_LABEL_LENGTH];\n", indent + 3);
+      PTFI("HostAtom *host_atoms = hostLabelAtoms(label, inline_atoms);\n", indent + 3);
+      PTFI("HostAtom *item = host_atoms;\n", indent + 3);
       int atom_count = 1;
       while(item != NULL)
       {
          PTFI("/* Matching rule atom %d. */\n", indent + 3, atom_count);
          generateAtomMatchingCode(rule, item->atom, indent + 3);
+         if(item->next != NULL) PTFI("item = &host_atoms[%d];\n\n", indent + 3, atom_count);
          atom_count++;
-         if(item->next != NULL) PTFI("item = item->next;\n\n", indent + 3);
          item = item->next;
       }
       PTFI("match = true;\n", indent + 3);
@@ -188,12 +221,26 @@ void generateVariableListMatchingCode(Rule *rule, RuleLabel label, int indent)
       }
       PTFI("if(label.length == 1)\n", indent );
       PTFI("{\n", indent);
-      PTFI("if(label.list->first->atom.type == 'i')\n", indent + 3);
-      PTFI("result = addIntegerAssignment(morphism, %d, label.list->first->atom.num);\n", 
+      PTFI("if(label.list == NULL)\n", indent + 3);
+      PTFI("result = addIntegerAssignment(morphism, %d, label.inline_list[0]);\n", 
+           indent + 6, list_variable_id);
+      PTFI("else if(label.list->atoms[0].type == 'i')\n", indent + 3);
+      PTFI("result = addIntegerAssignment(morphism, %d, label.list->atoms[0].num);\n", 
            indent + 6, list_variable_id);
-      PTFI("else result = addStringAssignment(morphism, %d, label.list->first->atom.str);\n",
+      PTFI("else result = addStringAssignment(morphism, %d, label.list->atoms[0].str);\n",
            indent + 3, list_variable_id);
       PTFI("}\n", indent);
+      /* List variables are assigned HostLists, so an inline host list is added
+       * to the list store for the assignment. */
+      PTFI("else if(label.list == NULL && label.length > 0)\n", indent);
+      PTFI("{\n", indent);
+      PTFI("HostAtom inline_atoms[INLINE_LABEL_LENGTH];\n", indent + 3);
+      PTFI("HostList *list = makeHostList(expandInlineList(&label, inline_atoms),\n", 
+           indent + 3);
+      PTFI("                              label.length, false);\n", indent + 3);
+      PTFI("result = addListAssignment(morphism, %d, list);\n", indent + 3, list_variable_id);
+      PTFI("removeHostList(list);\n", indent + 3);
+      PTFI("}\n", indent);
       PTFI("else result = addListAssignment(morphism, %d, label.list);\n",
            indent, list_variable_id);
       generateVariableResultCode(rule, list_variable_id, true, indent);
@@ -210,94 +257,66 @@ void generateVariableListMatchingCode(Rule *rule, RuleLabel label, int indent)
    /* Check if the host label has enough atoms to match those in the rule. 
     * Subtracting 1 from the rule label's length gives the number of atoms it
     * contains: the list variable is not counted because it can match the
-    * empty list. */
+    * empty list. Once this holds, every rule atom before the list variable
+    * corresponds to the host atom at the same position from the start of the
+    * host list, and every rule atom after it to the host atom at the same 
+    * position from the end. */
    PTFI("if(label.length < %d) break;\n", indent + 3, label.length - 1); 
-   PTFI("/* Matching from the start of the host list. */\n", indent + 3);
-   PTFI("HostListItem *item = label.list->first;\n", indent + 3);
-   int atom_count = 1;
+   PTFI("HostAtom inline_atoms[INLINE_LABEL_LENGTH];\n", indent + 3);
+   PTFI("HostAtom *host_atoms = hostLabelAtoms(label, inline_atoms);\n", indent + 3);
+   PTFI("HostAtom *item = NULL;\n", indent + 3);
+   int prefix_atoms = 0;
    while(item != NULL)
    {
       if(item->atom->type == VARIABLE && item->atom->variable.type == LIST_VAR) break;
-      PTFI("/* Check if the end of the host list has been reached. */\n", indent + 3);
-      PTFI("if(item == NULL) break;\n", indent + 3);
-      PTFI("/* Matching rule atom %d. */\n", indent + 3, atom_count);
+      if(prefix_atoms == 0) PTFI("/* Matching from the start of the host list. */\n", indent + 3);
+      PTFI("/* Matching rule atom %d. */\n", indent + 3, prefix_atoms + 1);
+      PTFI("item = &host_atoms[%d];\n", indent + 3, prefix_atoms);
       generateAtomMatchingCode(rule, item->atom, indent + 3);
-      PTFI("item = item->next;\n\n", indent + 3);
-      atom_count++;
+      PTF("\n");
+      prefix_atoms++;
       item = item->next;
    }
 
    item = label.list->last;
+   int suffix_atoms = 0;
+   while(item != NULL)
+   {
+      if(item->atom->type == VARIABLE && item->atom->variable.type == LIST_VAR) break;
+      if(suffix_atoms == 0) PTFI("/* Matching from the end of the host list. */\n", indent + 3);
+      PTFI("/* Matching rule atom %d. */\n", indent + 3, label.length - suffix_atoms);
+      PTFI("item = &host_atoms[label.length - %d];\n", indent + 3, suffix_atoms + 1);
+      generateAtomMatchingCode(rule, item->atom, indent + 3);
+      PTF("\n");
+      suffix_atoms++;
+      item = item->prev;
+   }
+
    if(!result_declared)
    {
       PTFI("int result = -1;\n", indent + 3);
       result_declared = true;
    }
-   PTFI("HostListItem *start = item;\n", indent + 3);
-   int host_atoms_matched = atom_count -1;
-   atom_count = label.length;
-   if(item->atom->type == VARIABLE && item->atom->variable.type == LIST_VAR)
-   {
-      PTFI("/* Matching list variable %d. */\n", indent + 3, list_variable_id);
-      /* All host atoms are matched: assign the empty list to the list variable. */
-      PTFI("if(start == NULL) result = addListAssignment(morphism, %d, NULL);\n", 
-           indent + 3, list_variable_id);
-   }
-   else
-   {
-      PTFI("/* The current host list position marks the start of the list that is\n", indent + 3);
-      PTFI("   assigned to the list variable. */\n", indent + 3);
-      PTFI("/* More rule atoms to match. If the end of the host list is reached, break. */\n",
-           indent + 3);
-      PTFI("if(start == NULL) break;\n\n", indent + 3);
-      PTFI("/* Matching from the end of the host list. */\n", indent + 3);
-      PTFI("item = label.list->last;\n", indent + 3);
-      while(item != NULL)
-      {
-         if(item->atom->type == VARIABLE && item->atom->variable.type == LIST_VAR) break;
-         PTFI("/* Check if the host list has passed \"start\". */\n", indent + 3);
-         PTFI("if(item == start->prev) break;\n", indent + 3);
-         PTFI("/* Matching rule atom %d */\n", indent + 3, atom_count);
-         generateAtomMatchingCode(rule, item->atom, indent + 3);
-         PTFI("item = item->prev;\n", indent + 3);
-         atom_count--;
-         item = item->prev;
-      }
-      /* Assign the list variable to the rest of the host list. */
-      PTFI("/* Matching list variable %d. */\n", indent + 3, list_variable_id);
-
-      /* All host atoms are matched: assign the empty list to the list variable. */
-      PTFI("if(item == start->prev) ", indent + 3);
-      PTF("result = addListAssignment(morphism, %d, NULL);\n", list_variable_id);
-   }  
-
-   /* All but 1 host atoms are matched: assign the remaining host atom to the list variable. */
-   PTFI("else if(item == start)\n", indent + 3);
+   /* The host atoms between the matched prefix and suffix are assigned to the
+    * list variable. */
+   PTFI("/* Matching list variable %d. */\n", indent + 3, list_variable_id);
+   PTFI("int sublist_length = label.length - %d;\n", indent + 3, label.length - 1);
+   PTFI("HostAtom *sublist = &host_atoms[%d];\n", indent + 3, prefix_atoms);
+   /* A sublist of two or more atoms is assigned as a view of the host list. 
+    * The host list is not stored inline: an inline list has too few atoms. */
+   PTFI("if(sublist_length == 0) result = addListAssignment(morphism, %d, NULL);\n",
+        indent + 3, list_variable_id);
+   PTFI("else if(sublist_length == 1)\n", indent + 3);
    PTFI("{\n", indent + 3);
-   PTFI("if(item->atom.type == 'i') result = addIntegerAssignment(morphism, %d, item->atom.num);\n", 
+   PTFI("if(sublist->type == 'i') result = addIntegerAssignment(morphism, %d, sublist->num);\n", 
         indent + 6, list_variable_id);
-   PTFI("else result = addStringAssignment(morphism, %d, item->atom.str);\n", 
+   PTFI("else result = addStringAssignment(morphism, %d, sublist->str);\n", 
         indent + 6, list_variable_id);
    PTFI("}\n", indent + 3);
-
-   /* More than one host atoms are unmatched: assign the unmatched sublist to the list variable. */
    PTFI("else\n", indent + 3);
    PTFI("{\n", indent + 3);
-   PTFI("/* Assign to variable %d the unmatched sublist of the host list. */\n",
-        indent + 6, list_variable_id);
-   host_atoms_matched += (label.length - atom_count);
-   PTFI("HostAtom sublist[label.length - %d];\n", indent + 6, host_atoms_matched);
-   PTFI("int list_index = 0;\n", indent + 6);
-   PTFI("HostListItem *iterator = start;\n", indent + 6);
-   PTFI("while(iterator != item->next)\n", indent + 6);
-   PTFI("{\n", indent + 6);
-   PTFI("sublist[list_index++] = iterator->atom;\n", indent + 9);
-   PTFI("iterator = iterator->next;\n", indent + 9);
-   PTFI("}\n", indent + 6);
-   PTFI("HostList *list = makeHostList(sublist, label.length - %d, false);\n", indent + 6,  
-        host_atoms_matched);
-   PTFI("result = addListAssignment(morphism, %d, list);\n", indent + 6,
-        list_variable_id);
+   PTFI("result = addSublistAssignment(morphism, %d, label.list, %d, sublist_length);\n", 
+        indent + 6, list_variable_id, prefix_atoms);
    PTFI("}\n", indent + 3);
 
    generateVariableResultCode(rule, list_variable_id, true, indent + 3);
@@ -315,18 +334,23 @@ static void generateAtomMatchingCode(Rule *rule, RuleAtom *atom, int indent)
            break;
       
       case INTEGER_CONSTANT:
-           PTFI("if(item->atom.type != 'i') break;\n", indent);
-           PTFI("else if(item->atom.num != %d) break;\n", indent, atom->number);
+           PTFI("if(item->type != 'i') break;\n", indent);
+           PTFI("else if(item->num != %d) break;\n", indent, atom->number);
            break;
 
       case STRING_CONSTANT:
-           PTFI("if(item->atom.type != 's') break;\n", indent);
-           PTFI("else if(strcmp(item->atom.str, \"%s\") != 0) break;\n",
-                indent, atom->string);
+           /* Host strings are interned, so they are compared by pointer with
+            * the interned constant, which is created on first use. */
+           PTFI("static string constant%d = NULL;\n", indent, string_constant_count);
+           PTFI("if(constant%d == NULL) constant%d = internString(\"%s\");\n", indent,
+                string_constant_count, string_constant_count, atom->string);
+           PTFI("if(item->type != 's') break;\n", indent);
+           PTFI("else if(item->str != constant%d) break;\n", indent, string_constant_count);
+           string_constant_count++;
            break;
 
       case CONCAT:
-           PTFI("if(item->atom.type != 's') break;\n", indent);
+           PTFI("if(item->type != 's') break;\n", indent);
            PTFI("else\n", indent);
            PTFI("{\n", indent);
            generateConcatMatchingCode(rule, atom, indent + 3);
@@ -351,35 +375,35 @@ static void generateVariableMatchingCode(Rule *rule, RuleAtom *atom, int indent)
    {
       case INTEGER_VAR:
            PTFI("/* Matching integer variable %d. */\n", indent, atom->variable.id);
-           PTFI("if(item->atom.type != 'i') break;\n", indent);
-           PTFI("result = addIntegerAssignment(morphism, %d, item->atom.num);\n",
+           PTFI("if(item->type != 'i') break;\n", indent);
+           PTFI("result = addIntegerAssignment(morphism, %d, item->num);\n",
                 indent, atom->variable.id);
            generateVariableResultCode(rule, atom->variable.id, false, indent);
            break;
 
       case CHARACTER_VAR:
            PTFI("/* Matching character variable %d. */\n", indent, atom->variable.id);
-           PTFI("if(item->atom.type != 's') break;\n", indent);
-           PTFI("if(strlen(item->atom.str) != 1) break;\n", indent);
-           PTFI("result = addStringAssignment(morphism, %d, item->atom.str);\n", 
+           PTFI("if(item->type != 's') break;\n", indent);
+           PTFI("if(internedLength(item->str) != 1) break;\n", indent);
+           PTFI("result = addStringAssignment(morphism, %d, item->str);\n", 
                 indent , atom->variable.id);
            generateVariableResultCode(rule, atom->variable.id, false, indent);
            break;
 
       case STRING_VAR:
            PTFI("/* Matching string variable %d. */\n", indent, atom->variable.id);
-           PTFI("if(item->atom.type != 's') break;\n", indent);
-           PTFI("result = addStringAssignment(morphism, %d, item->atom.str);\n",
+           PTFI("if(item->type != 's') break;\n", indent);
+           PTFI("result = addStringAssignment(morphism, %d, item->str);\n",
                 indent, atom->variable.id);
            generateVariableResultCode(rule, atom->variable.id, false, indent);
            break;
 
       case ATOM_VAR:
            PTFI("/* Matching atom variable %d. */\n", indent, atom->variable.id);
-           PTFI("if(item->atom.type == 'i') "
-                "result = addIntegerAssignment(morphism, %d, item->atom.num);\n",
+           PTFI("if(item->type == 'i') "
+                "result = addIntegerAssignment(morphism, %d, item->num);\n",
                 indent, atom->variable.id);
-           PTFI("else result = addStringAssignment(morphism, %d, item->atom.str);\n",
+           PTFI("else result = addStringAssignment(morphism, %d, item->str);\n",
                 indent, atom->variable.id);
            generateVariableResultCode(rule, atom->variable.id, false, indent);
            break;
@@ -396,8 +420,14 @@ static void generateVariableMatchingCode(Rule *rule, RuleAtom *atom, int indent)
    }
 }
 
+/* The runtime variables offset and host_character are declared at most once in
+ * the scope of the matching code of each string expression. */
+bool offset_declared = false, host_character_declared = false;
+
 static void generateConcatMatchingCode(Rule *rule, RuleAtom *atom, int indent)
 {
+   offset_declared = false;
+   host_character_declared = false;
    StringList *list = NULL;
    list = stringExpToList(list, atom->bin_op.left_exp);
    list = stringExpToList(list, atom->bin_op.right_exp);
@@ -414,7 +444,7 @@ static void generateConcatMatchingCode(Rule *rule, RuleAtom *atom, int indent)
       iterator = iterator->next;
    }
    iterator = list;
-   PTFI("string host_string = item->atom.str;\n", indent);
+   PTFI("string host_string = item->str;\n", indent);
    PTFI("unsigned int start = 0, end = strlen(host_string) - 1;\n\n", indent);
    /* If there is no string variable, iterate through the StringList and 
     * generate code for each string expression. */
@@ -466,21 +496,19 @@ static void generateConcatMatchingCode(Rule *rule, RuleAtom *atom, int indent)
    PTF("\n");
    PTFI("/* Matching string variable %d. */\n", indent, iterator->variable_id);
    PTFI("if(end == start - 1) ", indent);
-   PTF("result = addStringAssignment(morphism, %d, \"\");\n", iterator->variable_id);
+   PTF("result = addSubstringAssignment(morphism, %d, \"\");\n", iterator->variable_id);
    PTFI("else\n", indent);
    PTFI("{\n", indent);
-   PTFI("char substring[end - start + 1];\n", indent + 3);
+   PTFI("char substring[end - start + 2];\n", indent + 3);
    PTFI("strncpy(substring, host_string + start, end - start + 1);\n", indent + 3);
    PTFI("substring[end - start + 1] = '\\0';\n", indent + 3);
-   PTFI("result = addStringAssignment(morphism, %d, substring);\n", 
+   PTFI("result = addSubstringAssignment(morphism, %d, substring);\n", 
         indent + 3, iterator->variable_id);
    generateVariableResultCode(rule, iterator->variable_id, false, indent);
    PTFI("}\n", indent);
    freeStringList(list);
 }
 
-bool offset_declared = false, host_character_declared = false;
-
 static void generateStringMatchingCode(Rule *rule, StringList *string_exp, 
                                        bool prefix, int indent)
 {
@@ -534,7 +562,7 @@ static void generateStringMatchingCode(Rule *rule, StringList *string_exp,
          if(prefix) PTF("host_string[start++];\n");
          else PTF("host_string[end--];\n");
       }
-      PTFI("result = addStringAssignment(morphism, %d, host_character);\n",
+      PTFI("result = addSubstringAssignment(morphism, %d, host_character);\n",
            indent, string_exp->variable_id);
       generateVariableResultCode(rule, string_exp->variable_id, false, indent);
    }
@@ -647,6 +675,13 @@ void generateLabelEvaluationCode(RuleLabel label, bool node, int count, int cont
       }
       return;
    }
+   #ifdef LIST_HASHING
+      if(context == 0 && constantLabel(label) && !inlineConstantLabel(label))
+      {
+         generateConstantLabelCode(label, node, indent);
+         return;
+      }
+   #endif
    /* The length of the evaluated list is not static because right labels contain an
     * arbitrary number of list variables. For each list variable in the label, add
     * its length to the runtime accumulator <list_var_length>. A compile-time
@@ -717,12 +752,10 @@ void generateLabelEvaluationCode(RuleLabel label, bool node, int count, int cont
               {
                  PTFI("if(var_%d.type == 'l' && var_%d.list != NULL)\n", indent, id, id);
                  PTFI("{\n", indent);
-                 PTFI("HostListItem *item%d = var_%d.list->first;\n", indent + 3, count, id);
-                 PTFI("while(item%d != NULL)\n", indent + 3, count);
-                 PTFI("{\n", indent + 3);
-                 PTFI("array%d[index%d++] = item%d->atom;\n", indent + 6, count, count, count);
-                 PTFI("item%d = item%d->next;\n", indent + 6, count, count);
-                 PTFI("}\n", indent + 3);
+                 PTFI("memcpy(array%d + index%d, assignmentAtoms(var_%d),\n", 
+                      indent + 3, count, count, id);
+                 PTFI("       var_%d.length * sizeof(HostAtom));\n", indent + 3, id);
+                 PTFI("index%d += var_%d.length;\n", indent + 3, count, id);
                  PTFI("}\n", indent);
                  PTFI("else if(var_%d.type == 'i')\n", indent, id);
                  PTFI("{\n", indent);
@@ -804,24 +837,92 @@ void generateLabelEvaluationCode(RuleLabel label, bool node, int count, int cont
          else PTFI("HostLabel host_label%d = getEdgeLabel(host, host_edge_index);\n",
                    indent, host_label_count);
       }
-      PTFI("if(list_length%d > 0)\n", indent, count);
-      PTFI("{\n", indent);
-      PTFI("HostList *list%d = makeHostList(array%d, list_length%d, false);\n",
-           indent + 3, count, count, count);
-      if(label.mark == ANY)
-         PTFI("label = makeHostLabel(host_label%d.mark, list_length%d, list%d);\n", 
-              indent + 3, host_label_count, count, count);
-      else PTFI("label = makeHostLabel(%d, list_length%d, list%d);\n",
-                indent + 3, label.mark, count, count);
-      PTFI("}\n", indent);
       if(label.mark == ANY)
-         PTFI("else label = makeEmptyLabel(host_label%d.mark);\n\n", indent, host_label_count);
-      else PTFI("else label = makeEmptyLabel(%d);\n\n", indent, label.mark);
+         PTFI("label = makeHostLabelFromAtoms(host_label%d.mark, list_length%d, "
+              "array%d, false);\n\n", indent, host_label_count, count, count);
+      else PTFI("label = makeHostLabelFromAtoms(%d, list_length%d, array%d, false);\n\n",
+                indent, label.mark, count, count);
       host_label_count++;
    }
    else PTF("\n");
 }
 
+/* Returns true if every atom of the label's list is an integer or string constant. */
+static bool constantLabel(RuleLabel label)
+{
+   RuleListItem *item;
+   for(item = label.list->first; item != NULL; item = item->next)
+      if(item->atom->type != INTEGER_CONSTANT && item->atom->type != STRING_CONSTANT)
+         return false;
+   return true;
+}
+
+/* Returns true if the label is a constant list that the runtime stores inline:
+ * at most INLINE_LABEL_LENGTH integer constants. */
+static bool inlineConstantLabel(RuleLabel label)
+{
+   if(label.length == 0 || label.length > INLINE_LABEL_LENGTH) return false;
+   RuleListItem *item;
+   for(item = label.list->first; item != NULL; item = item->next)
+      if(item->atom->type != INTEGER_CONSTANT) return false;
+   return true;
+}
+
+/* Generates a static pointer to the constant list of the label, which is built
+ * and added to the list store the first time the code is executed. The pointer
+ * keeps a reference to the list for the rest of the run. Returns the number
+ * identifying the pointer. */
+static int generateConstantListCode(RuleLabel label, int indent)
+{
+   int count = constant_list_count++;
+   PTFI("static HostList *constant_list%d = NULL;\n", indent, count);
+   PTFI("if(constant_list%d == NULL)\n", indent, count);
+   PTFI("{\n", indent);
+   PTFI("HostAtom constant_array%d[%d];\n", indent + 3, count, label.length);
+   int index = 0;
+   RuleListItem *item;
+   for(item = label.list->first; item != NULL; item = item->next)
+   {
+      if(item->atom->type == INTEGER_CONSTANT)
+      {
+         PTFI("constant_array%d[%d].type = 'i';\n", indent + 3, count, index);
+         PTFI("constant_array%d[%d].num = %d;\n", indent + 3, count, index, 
+              item->atom->number);
+      }
+      else
+      {
+         PTFI("constant_array%d[%d].type = 's';\n", indent + 3, count, index);
+         PTFI("constant_array%d[%d].str = \"%s\";\n", indent + 3, count, index, 
+              item->atom->string);
+      }
+      index++;
+   }
+   PTFI("constant_list%d = makeHostList(constant_array%d, %d, false);\n", 
+        indent + 3, count, count, label.length);
+   PTFI("}\n", indent);
+   return count;
+}
+
+/* The constant RHS list is interned once, so later applications of the rule
+ * only increment its reference count. */
+static void generateConstantLabelCode(RuleLabel label, bool node, int indent)
+{
+   int count = generateConstantListCode(label, indent);
+   PTFI("addHostList(constant_list%d);\n", indent, count);
+   if(label.mark == ANY)
+   {
+      if(node) PTFI("HostLabel host_label%d = getNodeLabel(host, host_node_index);\n",
+                    indent, host_label_count);
+      else PTFI("HostLabel host_label%d = getEdgeLabel(host, host_edge_index);\n",
+                indent, host_label_count);
+      PTFI("label = makeHostLabel(host_label%d.mark, %d, constant_list%d);\n\n", 
+           indent, host_label_count, label.length, count);
+   }
+   else PTFI("label = makeHostLabel(%d, %d, constant_list%d);\n\n", 
+             indent, label.mark, label.length, count);
+   host_label_count++;
+}
+
 /* Navigates an integer expression tree and writes the arithmetic expression it 
  * represents. For example, given the label (i + 1) * length(s), where i is an
  * integer variable and s is a string variable, generateIntExpression prints:
@@ -836,10 +937,10 @@ void generateIntExpression(RuleAtom *atom, int context, bool nested)
 
       case LENGTH:
            if(atom->variable.type == STRING_VAR)
-              PTF("(int)strlen(var_%d)", atom->variable.id);
+              PTF("internedLength(var_%d)", atom->variable.id);
 
            else if(atom->variable.type == ATOM_VAR)
-              PTF("((var_%d.type == 's') ? (int)strlen(var_%d.str) : 1)", 
+              PTF("((var_%d.type == 's') ? internedLength(var_%d.str) : 1)", 
                   atom->variable.id, atom->variable.id);
 
            else if(atom->variable.type == LIST_VAR)
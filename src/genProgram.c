@@ -62,7 +62,7 @@ typedef enum {MAIN_BODY, IF_BODY, TRY_BODY, LOOP_BODY} ContextType;
    int indent;
 } CommandData;
 
-/* Arguments passed to the newGraph function at runtime. */
+/* Minimum arguments passed to the newGraph function at runtime. */
 #define HOST_NODE_SIZE 128
 #define HOST_EDGE_SIZE 128
 
@@ -112,6 +112,8 @@ void generateRuntimeMain(List *declarations, string output_dir)
    PTF("   freeMorphisms();\n");
    if(graph_copying) PTF("   freeGraphStack();\n");
    else PTF("   freeGraphChangeStack();\n");
+   PTF("   freeStringTable();\n");
+   PTF("   freePools();\n");
    PTF("   closeLogFile();\n");
    #if defined GRAPH_TRACING || defined RULE_TRACING || defined BACKTRACK_TRACING
       PTF("   closeTraceFile();\n");
@@ -119,7 +121,7 @@ void generateRuntimeMain(List *declarations, string output_dir)
    PTF("}\n\n");
 
    PTF("Graph *host = NULL;\n");
-   PTF("int *node_map = NULL;\n\n");
+   PTF("NodeIDMap *node_map = NULL;\n\n");
 
    /* Print the function that builds the host graph via the host graph parser. */
    PTF("static Graph *buildHostGraph(char *host_file)\n");
@@ -130,17 +132,18 @@ void generateRuntimeMain(List *declarations, string output_dir)
    PTFI("perror(host_file);\n", 6);
    PTFI("return NULL;\n", 6);
    PTFI("}\n\n", 3);
-   PTFI("host = newGraph(%d, %d);\n", 3, HOST_NODE_SIZE, HOST_EDGE_SIZE);
-   PTFI("node_map = calloc(%d, sizeof(int));\n", 3, HOST_NODE_SIZE);
-   PTFI("if(node_map == NULL)\n", 3);
-   PTFI("{\n", 3);
-   PTFI("freeGraph(host);\n", 6);
-   PTFI("return NULL;\n", 6);
-   PTFI("}\n", 3);
+   PTFI("/* Count the nodes and edges of the host graph so that the graph and\n", 3);
+   PTFI(" * node_map are allocated at their final size before parsing. */\n", 3);
+   PTFI("int nodes = 0, edges = 0, max_node_id = -1;\n", 3);
+   PTFI("countHostGraphItems(yyin, &nodes, &edges, &max_node_id);\n", 3);
+   PTFI("host = newGraph(nodes < %d ? %d : nodes, edges < %d ? %d : edges);\n", 3,
+        HOST_NODE_SIZE, HOST_NODE_SIZE, HOST_EDGE_SIZE, HOST_EDGE_SIZE);
+   PTFI("node_map = makeNodeIDMap(nodes, max_node_id);\n", 3);
    PTFI("/* The parser populates the host graph using node_map to add edges with\n", 3);
    PTFI(" * the correct source and target indices. */\n", 3);
    PTFI("int result = yyparse();\n", 3);
-   PTFI("free(node_map);\n", 3);
+   PTFI("freeNodeIDMap(node_map);\n", 3);
+   PTFI("node_map = NULL;\n", 3);
    PTFI("fclose(yyin);\n", 3);
    PTFI("if(result == 0) return host;\n", 3);
    PTFI("else\n", 3);
@@ -440,7 +443,13 @@ static void generateRuleCall(string rule_name, bool empty_lhs, bool predicate,
       #ifdef RULE_TRACING
          PTFI("print_trace(\"Matching %s...\\n\");\n", data.indent, rule_name);
       #endif
-      PTFI("if(match%s(M_%s))\n", data.indent, rule_name, rule_name);
+      /* The body of a loop without a restore point is a single rule call, which
+       * is repeated until it fails. Each call first tries the items touched by
+       * the previous application, and then resumes the search of the previous
+       * call instead of rescanning the host graph from the start. */
+      if(data.context == LOOP_BODY && data.restore_point < 0)
+         PTFI("if(frontierMatch%s(M_%s))\n", data.indent, rule_name, rule_name);
+      else PTFI("if(match%s(M_%s))\n", data.indent, rule_name, rule_name);
       PTFI("{\n", data.indent);
       #ifdef RULE_TRACING
          PTFI("print_trace(\"Matched %s.\\n\\n\");\n", data.indent + 3, rule_name);
@@ -462,6 +471,11 @@ static void generateRuleCall(string rule_name, bool empty_lhs, bool predicate,
                     data.indent + 3, rule_name);
                PTFI("printGraph(host, trace_file);\n\n", data.indent + 3);
             #endif
+            /* Outside recording contexts, no restore point or graph change record
+             * holds host graph indices, and the morphism has been reset by the
+             * rule application. This is a safe point to compact the host graph. */
+            if(!data.record_changes && data.restore_point < 0)
+               PTFI("compactGraph(host);\n", data.indent + 3);
          }
          else PTFI("initialiseMorphism(M_%s, host);\n", data.indent + 3, rule_name);
       }
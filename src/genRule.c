@@ -16,15 +16,21 @@
 #include "genRule.h"
 
 static void generateMatchingCode(Rule *rule, bool predicate);
+static void generateFailureMemoCode(Rule *rule);
+static int getLabelTables(RuleLabel label, int *marks, int *label_classes);
 static void emitDegreeCheck(RuleNode *left_node, int indent);
 static void emitRootNodeMatcher(Rule *rule, RuleNode *left_node, SearchOp *next_op);
 static void emitNodeMatcher(Rule *rule, RuleNode *left_node, SearchOp *next_op);
 static void emitNodeFromEdgeMatcher(Rule *rule, RuleNode *left_node, char type, SearchOp *next_op);
+static void emitRootNodeFilters(RuleNode *left_node);
 static void emitNodeMatchResultCode(RuleNode *node, SearchOp *next_op, int indent);
 static void emitEdgeMatcher(Rule *rule, RuleEdge *left_edge, SearchOp *next_op);
 static void emitLoopEdgeMatcher(Rule *rule, RuleEdge *left_edge, SearchOp *next_op);
 static void emitEdgeFromNodeMatcher(Rule *rule, RuleEdge *left_edge, bool source,
-                                    bool initialise, bool exit, SearchOp *next_op);
+                                    bool bidirectional, SearchOp *next_op);
+static void emitEdgeFromNodeCandidateCode(Rule *rule, RuleEdge *left_edge, bool incident,
+                                          bool source, bool bidirectional, SearchOp *next_op,
+                                          int indent);
 static void emitEdgeMatchResultCode(int index, SearchOp *next_op, int indent);
 static void emitNextMatcherCall(SearchOp *next_operation);
 
@@ -144,6 +150,24 @@ static void generateMatchingCode(Rule *rule, bool predicate)
       freeSearchplan(searchplan);
       return;
    }
+   /* The callback of forEachMatch<Rule>, called by reportMatch for each complete
+    * match. Without a callback, the first complete match ends the search. */
+   PTF("static MatchCallback match_callback = NULL;\n");
+   PTF("static void *match_callback_data = NULL;\n");
+   /* Set by resumeMatch<Rule>. The matchers that scan host item lists start
+    * their scan at the position where they last found a candidate. */
+   PTF("static bool resume_search = false;\n");
+   /* Set by frontierMatch<Rule>. The matchers that scan host item lists first
+    * try the items in the dirty frontier of the host graph. */
+   PTF("static bool frontier_search = false;\n\n");
+   PTF("/* All items matched! Returns true to stop searching with this match in the\n");
+   PTF(" * morphism, or false to backtrack and search for the next match. */\n");
+   PTF("static bool reportMatch(Morphism *morphism)\n");
+   PTF("{\n");
+   PTFI("if(match_callback == NULL) return true;\n", 3);
+   PTFI("return match_callback(morphism, match_callback_data);\n", 3);
+   PTF("}\n\n");
+
    SearchOp *operation = searchplan->first;
    /* Iterator over the searchplan to print the prototypes of the matching functions. */
    while(operation != NULL)
@@ -177,6 +201,8 @@ static void generateMatchingCode(Rule *rule, bool predicate)
       }
       operation = operation->next;
    }
+   generateFailureMemoCode(rule);
+
    /* Generate the main matching function which sets up the runtime matching 
     * environment and calls the first matching function. */
    fprintf(header, "bool match%s(Morphism *morphism);\n\n", rule->name);
@@ -184,6 +210,9 @@ static void generateMatchingCode(Rule *rule, bool predicate)
    PTF("{\n");
    PTFI("if(%d > host->number_of_nodes || %d > host->number_of_edges) return false;\n",
         3, rule->lhs->node_index, rule->lhs->edge_index);
+   /* A search that enumerates matches for a callback may fail after finding
+    * matches, so only searches without a callback are memoized. */
+   PTFI("if(match_callback == NULL && failureUnchanged()) return false;\n", 3);
    char item = searchplan->first->is_node ? 'n' : 'e';
    
    if(predicate)
@@ -192,6 +221,7 @@ static void generateMatchingCode(Rule *rule, bool predicate)
       /* Reset the matched flags in the host graph. This is normally done after
        * rule application, but predicate rules are not applied. */
       PTFI("initialiseMorphism(morphism, host);\n", 3);
+      PTFI("if(!match && match_callback == NULL) recordFailure();\n", 3);
       PTFI("return match;\n", 3);
    }
    else 
@@ -200,11 +230,48 @@ static void generateMatchingCode(Rule *rule, bool predicate)
       PTFI("else\n", 3);
       PTFI("{\n", 3);
       PTFI("initialiseMorphism(morphism, host);\n", 6);
+      PTFI("if(match_callback == NULL) recordFailure();\n", 6);
       PTFI("return false;\n", 6);
       PTFI("}\n", 3);
    }
    PTF("}\n\n");
 
+   /* Generate the function that enumerates the matches of the rule. */
+   fprintf(header, "bool forEachMatch%s(Morphism *morphism, MatchCallback callback, "
+                   "void *data);\n\n", rule->name);
+   PTF("bool forEachMatch%s(Morphism *morphism, MatchCallback callback, void *data)\n", 
+       rule->name);
+   PTF("{\n");
+   PTFI("match_callback = callback;\n", 3);
+   PTFI("match_callback_data = data;\n", 3);
+   PTFI("bool stopped = match%s(morphism);\n", 3, rule->name);
+   PTFI("match_callback = NULL;\n", 3);
+   PTFI("match_callback_data = NULL;\n", 3);
+   PTFI("return stopped;\n", 3);
+   PTF("}\n\n");
+
+   /* Generate the function that resumes the search of the previous call. It
+    * finds the same matches as match<Rule>, possibly in a different order. */
+   fprintf(header, "bool resumeMatch%s(Morphism *morphism);\n\n", rule->name);
+   PTF("bool resumeMatch%s(Morphism *morphism)\n", rule->name);
+   PTF("{\n");
+   PTFI("resume_search = true;\n", 3);
+   PTFI("bool match = match%s(morphism);\n", 3, rule->name);
+   PTFI("resume_search = false;\n", 3);
+   PTFI("return match;\n", 3);
+   PTF("}\n\n");
+
+   /* Generate the function that tries the items touched by the last rule
+    * application first and then resumes the search of the previous call. */
+   fprintf(header, "bool frontierMatch%s(Morphism *morphism);\n\n", rule->name);
+   PTF("bool frontierMatch%s(Morphism *morphism)\n", rule->name);
+   PTF("{\n");
+   PTFI("frontier_search = true;\n", 3);
+   PTFI("bool match = resumeMatch%s(morphism);\n", 3, rule->name);
+   PTFI("frontier_search = false;\n", 3);
+   PTFI("return match;\n", 3);
+   PTF("}\n\n");
+
    /* Iterator over the searchplan to print the definitions of the matching functions. */
    operation = searchplan->first;
    RuleNode *node = NULL;
@@ -242,22 +309,14 @@ static void generateMatchingCode(Rule *rule, bool predicate)
 
          case 's': 
               edge = getRuleEdge(rule->lhs, operation->index);
-              if(edge->bidirectional) 
-              {
-                 emitEdgeFromNodeMatcher(rule, edge, true, true, false, operation->next);
-                 emitEdgeFromNodeMatcher(rule, edge, false, false, true, operation->next);
-              }
-              else emitEdgeFromNodeMatcher(rule, edge, true, true, true, operation->next);
+              emitEdgeFromNodeMatcher(rule, edge, true, edge->bidirectional,
+                                      operation->next);
               break;
 
          case 't':
               edge = getRuleEdge(rule->lhs, operation->index);
-              if(edge->bidirectional) 
-              {
-                 emitEdgeFromNodeMatcher(rule, edge, false, true, false, operation->next);
-                 emitEdgeFromNodeMatcher(rule, edge, true, false, true, operation->next);
-              }
-              else emitEdgeFromNodeMatcher(rule, edge, false, true, true, operation->next);
+              emitEdgeFromNodeMatcher(rule, edge, false, edge->bidirectional,
+                                      operation->next);
               break;
          
          default:
@@ -271,6 +330,87 @@ static void generateMatchingCode(Rule *rule, bool predicate)
 }
 
 
+/* Failure memoization. A failed search is not repeated while the parts of the
+ * host graph on which the matches of the rule depend are unchanged. These are
+ * the label class tables from which the LHS nodes and edges draw candidates,
+ * the root node array if the LHS has a root node, and all edge tables if
+ * matchDependsOnAllEdges holds. The generated function recordFailure stores the
+ * modification epochs of these parts (see graph.h), and failureUnchanged
+ * checks if they still hold the stored values. */
+static void generateFailureMemoCode(Rule *rule)
+{
+   bool node_tables[ANY][NUMBER_OF_CLASSES], edge_tables[ANY][NUMBER_OF_CLASSES];
+   bool root = false;
+   int mark, label_class;
+   for(mark = NONE; mark < ANY; mark++)
+      for(label_class = 0; label_class < NUMBER_OF_CLASSES; label_class++)
+         node_tables[mark][label_class] = edge_tables[mark][label_class] = false;
+
+   int marks[ANY * NUMBER_OF_CLASSES], label_classes[ANY * NUMBER_OF_CLASSES];
+   int index, table, tables;
+   for(index = 0; index < rule->lhs->node_index; index++)
+   {
+      RuleNode *node = getRuleNode(rule->lhs, index);
+      if(node->root) root = true;
+      tables = getLabelTables(node->label, marks, label_classes);
+      for(table = 0; table < tables; table++)
+         node_tables[marks[table]][label_classes[table]] = true;
+   }
+   bool all_edges = matchDependsOnAllEdges(rule);
+   for(index = 0; index < rule->lhs->edge_index; index++)
+   {
+      RuleEdge *edge = getRuleEdge(rule->lhs, index);
+      tables = getLabelTables(edge->label, marks, label_classes);
+      for(table = 0; table < tables; table++)
+         edge_tables[marks[table]][label_classes[table]] = true;
+   }
+   int epochs = root ? 1 : 0;
+   for(mark = NONE; mark < ANY; mark++)
+      for(label_class = 0; label_class < NUMBER_OF_CLASSES; label_class++)
+      {
+         if(all_edges) edge_tables[mark][label_class] = true;
+         if(node_tables[mark][label_class]) epochs++;
+         if(edge_tables[mark][label_class]) epochs++;
+      }
+
+   PTF("static bool failure_recorded = false;\n");
+   PTF("static unsigned long long failure_epochs[%d];\n\n", epochs);
+   /* recordFailure and failureUnchanged are generated from the same loop so
+    * that the epochs are stored and compared in the same order. */
+   int pass;
+   for(pass = 0; pass < 2; pass++)
+   {
+      if(pass == 0) PTF("static void recordFailure(void)\n{\n");
+      else PTF("static bool failureUnchanged(void)\n{\n   return failure_recorded");
+      int epoch = 0;
+      if(root)
+      {
+         if(pass == 0) PTFI("failure_epochs[0] = host->root_epoch;\n", 3);
+         else PTF(" &&\n          failure_epochs[0] == host->root_epoch");
+         epoch++;
+      }
+      for(mark = NONE; mark < ANY; mark++)
+         for(label_class = 0; label_class < NUMBER_OF_CLASSES; label_class++)
+         {
+            int item;
+            for(item = 0; item < 2; item++)
+            {
+               if(!(item == 0 ? node_tables : edge_tables)[mark][label_class]) continue;
+               string field = item == 0 ? "node_epochs" : "edge_epochs";
+               if(pass == 0) 
+                  PTFI("failure_epochs[%d] = host->%s[%d][%d];\n", 3, 
+                       epoch, field, mark, label_class);
+               else PTF(" &&\n          failure_epochs[%d] == host->%s[%d][%d]", 
+                        epoch, field, mark, label_class);
+               epoch++;
+            }
+         }
+      if(pass == 0) PTFI("failure_recorded = true;\n", 3);
+      else PTF(";\n");
+      PTF("}\n\n");
+   }
+}
+
 /* The host node does not match the rule node if:
  * (1) The host node's indegree is strictly less than the rule node's indegree.
  * (2) The host node's outdegree is strictly less than the rule node's outdegree.
@@ -295,22 +435,167 @@ static void emitDegreeCheck(RuleNode *left_node, int indent)
    {
       /* Dangling node degree check. If the if condition evaluates to true,
        * then the node is not a valid match. */
-      PTFI("if(host_node->indegree < %d || host_node->outdegree < %d ||\n",
+      PTFI("if(nodeIndegree(host, host_index) < %d || nodeOutdegree(host, host_index) < %d ||\n",
            indent, left_node->indegree, left_node->outdegree);
-      PTFI("   ((host_node->outdegree + host_node->indegree - %d - %d - %d) != 0)) ", 
+      PTFI("   ((nodeOutdegree(host, host_index) + nodeIndegree(host, host_index)"
+           " - %d - %d - %d) != 0)) ", 
            indent, left_node->outdegree, left_node->indegree, left_node->bidegree);
    }
    else
    {
       /* Standard node degree check. */
-      PTFI("if(host_node->indegree < %d || host_node->outdegree < %d ||\n",
+      PTFI("if(nodeIndegree(host, host_index) < %d || nodeOutdegree(host, host_index) < %d ||\n",
            indent, left_node->indegree, left_node->outdegree);
-      PTFI("   ((host_node->outdegree + host_node->indegree - %d - %d - %d) < 0)) ", 
+      PTFI("   ((nodeOutdegree(host, host_index) + nodeIndegree(host, host_index)"
+           " - %d - %d - %d) < 0)) ", 
            indent, left_node->outdegree, left_node->indegree, left_node->bidegree);
    }
 }
 
  
+/* Stores the (mark, label class) pairs of the host label class tables from which
+ * candidates for an LHS item with the given label are drawn in the two arrays,
+ * which must have ANY * NUMBER_OF_CLASSES elements. Returns the number of
+ * tables. */
+static int getLabelTables(RuleLabel label, int *marks, int *label_classes)
+{
+   bool classes[NUMBER_OF_CLASSES];
+   getLabelClasses(label, classes);
+   int mark, label_class, tables = 0;
+   for(mark = NONE; mark < ANY; mark++)
+   {
+      if(label.mark == ANY ? mark == NONE : mark != label.mark) continue;
+      for(label_class = 0; label_class < NUMBER_OF_CLASSES; label_class++)
+      {
+         if(!classes[label_class]) continue;
+         marks[tables] = mark;
+         label_classes[tables++] = label_class;
+      }
+   }
+   return tables;
+}
+
+/* Emits the declarations of two static arrays listing the (mark, label class)
+ * pairs of the host label class tables from which candidates for an LHS item
+ * with the given label are drawn. Returns the number of tables. The mark of a
+ * candidate is guaranteed by its table, so the matchers using this function do
+ * not generate a mark check. */
+static int emitLabelTables(RuleLabel label)
+{
+   int marks[ANY * NUMBER_OF_CLASSES], label_classes[ANY * NUMBER_OF_CLASSES];
+   int tables = getLabelTables(label, marks, label_classes);
+   int index;
+   PTFI("static const int marks[%d] = {", 3, tables);
+   for(index = 0; index < tables; index++) PTF(index == 0 ? "%d" : ", %d", marks[index]);
+   PTF("};\n");
+   PTFI("static const int classes[%d] = {", 3, tables);
+   for(index = 0; index < tables; index++) 
+      PTF(index == 0 ? "%d" : ", %d", label_classes[index]);
+   PTF("};\n");
+   PTFI("int table_count, table_index;\n", 3);
+   return tables;
+}
+
+/* Emits the head of the scan over the host label class tables listed by
+ * emitLabelTables, up to the declaration of the candidate's host_index. The
+ * scan visits every table entry once in cyclic order, starting from the
+ * position saved in resume_count and resume_index if resume_search is set and
+ * from the first entry of the first table otherwise. The caller emits the
+ * statement that saves the position of a candidate and closes the two loops.
+ *
+ * The entries before the saved position are scanned last, so a call that finds
+ * no match has scanned every table in full. */
+static void emitTableScan(int tables, char item)
+{
+   PTFI("static int resume_count = 0, resume_index = 0;\n", 3);
+   PTFI("int start_count = resume_search ? resume_count : 0;\n", 3);
+   PTFI("int start_index = resume_search ? resume_index : 0;\n", 3);
+   PTFI("int step;\n", 3);
+   PTFI("for(step = 0; step <= %d; step++)\n", 3, tables);
+   PTFI("{\n", 3);
+   PTFI("table_count = (start_count + step) %% %d;\n", 6, tables);
+   if(item == 'n')
+      PTFI("IntArray *table = getNodeTable(host, marks[table_count], classes[table_count]);\n", 6);
+   else 
+      PTFI("IntArray *table = getEdgeTable(host, marks[table_count], classes[table_count]);\n", 6);
+   PTFI("int table_end = table->size;\n", 6);
+   PTFI("if(step == %d && start_index < table_end) table_end = start_index;\n", 6, tables);
+   PTFI("for(table_index = step == 0 ? start_index : 0; table_index < table_end; "
+        "table_index++)\n", 6);
+   PTFI("{\n", 6);
+   PTFI("int host_index = table->items[table_index];\n", 9);
+}
+
+/* Emits the head of the scan over the dirty frontier of the host graph (see
+ * graph.h), which is made if frontier_search is set, up to the declaration of
+ * the candidate's host_index. Frontier entries that no longer refer to an item
+ * of the graph are skipped. If tables is positive, so are the entries that are
+ * not in the label class tables listed by emitLabelTables. The caller emits
+ * the remaining filters and closes the loop and the if statement. */
+static void emitFrontierScan(char item, int tables)
+{
+   bool node = item == 'n';
+   PTFI("if(frontier_search)\n", 3);
+   PTFI("{\n", 3);
+   PTFI("IntArray *frontier = %s(host);\n", 6, node ? "getNodeFrontier" : "getEdgeFrontier");
+   PTFI("int frontier_index;\n", 6);
+   PTFI("for(frontier_index = 0; frontier_index < frontier->size; frontier_index++)\n", 6);
+   PTFI("{\n", 6);
+   PTFI("int host_index = frontier->items[frontier_index];\n", 9);
+   if(node)
+   {
+      PTFI("if(host_index < 0 || host_index >= host->nodes.size) continue;\n", 9);
+      PTFI("Node *host_node = getNode(host, host_index);\n", 9);
+      PTFI("if(host_node->index < 0) continue;\n", 9);
+   }
+   else
+   {
+      PTFI("if(host_index < 0 || host_index >= host->edges.size) continue;\n", 9);
+      PTFI("Edge *host_edge = getEdge(host, host_index);\n", 9);
+      PTFI("if(host_edge->index < 0) continue;\n", 9);
+   }
+   if(tables == 0) return;
+   PTFI("int label_class = getLabelClass(host_%s->label);\n", 9, node ? "node" : "edge");
+   PTFI("for(table_count = 0; table_count < %d; table_count++)\n", 9, tables);
+   PTFI("if(%sMark(host, host_index) == marks[table_count] &&\n", 12, node ? "node" : "edge");
+   PTFI("   label_class == classes[table_count]) break;\n", 12);
+   PTFI("if(table_count == %d) continue;\n", 9, tables);
+}
+
+/* Emits the function try_n<index> or try_e<index> that attempts to match the
+ * given rule item, exactly one of left_node and left_edge, to the host item
+ * host_index that has passed the candidate filters of the caller. It performs
+ * the label matching and, if the labels match, extends the morphism and calls
+ * the matcher of the next searchplan operation. */
+static void emitCandidateFunction(Rule *rule, RuleNode *left_node, RuleEdge *left_edge,
+                                  SearchOp *next_op)
+{
+   RuleLabel label;
+   if(left_node != NULL)
+   {
+      label = left_node->label;
+      PTF("static bool try_n%d(Morphism *morphism, int host_index)\n", left_node->index);
+      PTF("{\n");
+      PTFI("Node *host_node = getNode(host, host_index);\n", 3);
+      PTFI("HostLabel label = host_node->label;\n", 3);
+   }
+   else
+   {
+      label = left_edge->label;
+      PTF("static bool try_e%d(Morphism *morphism, int host_index)\n", left_edge->index);
+      PTF("{\n");
+      PTFI("Edge *host_edge = getEdge(host, host_index);\n", 3);
+      PTFI("HostLabel label = host_edge->label;\n", 3);
+   }
+   PTFI("bool match = false;\n", 3);
+   if(hasListVariable(label)) generateVariableListMatchingCode(rule, label, 3);
+   else generateFixedListMatchingCode(rule, label, 3);
+   if(left_node != NULL) emitNodeMatchResultCode(left_node, next_op, 3);
+   else emitEdgeMatchResultCode(left_edge->index, next_op, 3);
+   PTFI("return false;\n", 3);
+   PTF("}\n\n");
+}
+
 /* The emitMatcher functions in this module take an LHS item and emit a function 
  * that searches for a matching host item. The generated code queries the host graph
  * for the appropriate item or list of items according to the LHS item and the
@@ -328,62 +613,87 @@ static void emitDegreeCheck(RuleNode *left_node, int indent)
  * (4) Have label compatibility with the LHS-item. This is the last step because
  *     label matching is more computationally demanding than the other steps.
  *
+ * Checks (1) to (3) use the accessor macros of graph.h, which read the packed
+ * hot field arrays of the host graph in the HOT_COLD_SPLIT layout, so that the
+ * candidate's Node or Edge structure is only fetched for label matching.
+ *
  * If a valid host item is found, the generated code pushes its index to the
  * appropriate morphism stack and calls the function for the following 
  * searchplan operation (see emitNextMatcherCall). If there are no operations 
- * left, code is generated to return true. */
+ * left, code is generated to report the complete match.
+ *
+ * The matchers that draw candidates from the root node list or the label class
+ * tables perform check (4) and the steps after it in a separate function
+ * emitted by emitCandidateFunction, which is also called for the candidates
+ * drawn from the dirty frontier (see emitFrontierScan). */
 static void emitRootNodeMatcher(Rule *rule, RuleNode *left_node, SearchOp *next_op)
 {
+   emitCandidateFunction(rule, left_node, NULL, next_op);
    PTF("static bool match_n%d(Morphism *morphism)\n", left_node->index);
    PTF("{\n");
-   PTFI("RootNodes *nodes;\n", 3);   
-   PTFI("for(nodes = getRootNodeList(host); nodes != NULL; nodes = nodes->next)\n", 3);
+   emitFrontierScan('n', 0);
+   PTFI("if(!nodeRoot(host, host_index)) continue;\n", 9);
+   emitRootNodeFilters(left_node);
+   PTFI("if(try_n%d(morphism, host_index)) return true;\n", 9, left_node->index);
+   PTFI("}\n", 6);
+   PTFI("}\n", 3);
+   PTFI("IntArray *root_nodes = getRootNodeList(host);\n", 3);   
+   /* The root node list is scanned in cyclic order like the label class tables
+    * (see emitTableScan). */
+   PTFI("static int resume_index = 0;\n", 3);
+   PTFI("int start_index = resume_search ? resume_index : 0;\n", 3);
+   PTFI("int step, root_index;\n", 3);
+   PTFI("for(step = 0; step <= 1; step++)\n", 3);
    PTFI("{\n", 3);
-   PTFI("Node *host_node = getNode(host, nodes->index);\n", 6);
-   PTFI("if(host_node == NULL) continue;\n", 6);
-   PTFI("if(host_node->matched) continue;\n", 6);
-   if(left_node->label.mark == ANY)
-      PTFI("if(host_node->label.mark == 0) continue;\n", 6);
-   else PTFI("if(host_node->label.mark != %d) continue;\n", 6, left_node->label.mark);
-   emitDegreeCheck(left_node, 6);  
-   PTF("continue;\n\n");
-
-   PTFI("HostLabel label = host_node->label;\n", 6);
-   PTFI("bool match = false;\n", 6);
-   if(hasListVariable(left_node->label))
-      generateVariableListMatchingCode(rule, left_node->label, 6);
-   else generateFixedListMatchingCode(rule, left_node->label, 6);
-   emitNodeMatchResultCode(left_node, next_op, 6);
+   PTFI("int root_end = root_nodes->size;\n", 6);
+   PTFI("if(step == 1 && start_index < root_end) root_end = start_index;\n", 6);
+   PTFI("for(root_index = step == 0 ? start_index : 0; root_index < root_end; "
+        "root_index++)\n", 6);
+   PTFI("{\n", 6);
+   PTFI("int host_index = root_nodes->items[root_index];\n", 9);
+   emitRootNodeFilters(left_node);
+   PTFI("resume_index = root_index;\n", 9);
+   PTFI("if(try_n%d(morphism, host_index)) return true;\n", 9, left_node->index);
+   PTFI("}\n", 6);
    PTFI("}\n", 3);
    PTFI("return false;\n", 3);
    PTF("}\n\n");
 }
 
+static void emitRootNodeFilters(RuleNode *left_node)
+{
+   PTFI("if(nodeMatched(host, host_index)) continue;\n", 9);
+   if(left_node->label.mark == ANY)
+      PTFI("if(nodeMark(host, host_index) == 0) continue;\n", 9);
+   else PTFI("if(nodeMark(host, host_index) != %d) continue;\n", 9, left_node->label.mark);
+   emitDegreeCheck(left_node, 9);  
+   PTF("continue;\n");
+}
+
 /* The rule node is matched "in isolation", in that it is not the source or
  * target of a previously-matched edge. In this case, the candidate host
  * graph nodes are obtained from the appropriate label class tables. */
 static void emitNodeMatcher(Rule *rule, RuleNode *left_node, SearchOp *next_op)
 {
+   emitCandidateFunction(rule, left_node, NULL, next_op);
    PTF("static bool match_n%d(Morphism *morphism)\n", left_node->index);
    PTF("{\n");
-   PTFI("int host_index;\n", 3);
-   PTFI("for(host_index = 0; host_index < host->nodes.size; host_index++)\n", 3);
-   PTFI("{\n", 3);
-   PTFI("Node *host_node = getNode(host, host_index);\n", 6);
-   PTFI("if(host_node == NULL || host_node->index == -1) continue;\n", 6);
-   PTFI("if(host_node->matched) continue;\n", 6);
-   if(left_node->label.mark == ANY)
-      PTFI("if(host_node->label.mark == 0) continue;\n", 6);
-   else PTFI("if(host_node->label.mark != %d) continue;\n", 6, left_node->label.mark);
-   emitDegreeCheck(left_node, 6);  
-   PTF("continue;\n\n");
-
-   PTFI("HostLabel label = host_node->label;\n", 6);
-   PTFI("bool match = false;\n", 6);
-   if(hasListVariable(left_node->label))
-      generateVariableListMatchingCode(rule, left_node->label, 6);
-   else generateFixedListMatchingCode(rule, left_node->label, 6);
-   emitNodeMatchResultCode(left_node, next_op, 6);
+   int tables = emitLabelTables(left_node->label);
+   emitFrontierScan('n', tables);
+   PTFI("if(nodeMatched(host, host_index)) continue;\n", 9);
+   emitDegreeCheck(left_node, 9);  
+   PTF("continue;\n");
+   PTFI("if(try_n%d(morphism, host_index)) return true;\n", 9, left_node->index);
+   PTFI("}\n", 6);
+   PTFI("}\n", 3);
+   emitTableScan(tables, 'n');
+   PTFI("if(nodeMatched(host, host_index)) continue;\n", 9);
+   emitDegreeCheck(left_node, 9);  
+   PTF("continue;\n");
+   PTFI("resume_count = table_count;\n", 9);
+   PTFI("resume_index = table_index;\n", 9);
+   PTFI("if(try_n%d(morphism, host_index)) return true;\n", 9, left_node->index);
+   PTFI("}\n", 6);
    PTFI("}\n", 3);
    PTFI("return false;\n", 3);
    PTF("}\n\n");
@@ -401,17 +711,16 @@ static void emitNodeFromEdgeMatcher(Rule *rule, RuleNode *left_node, char type,
    PTF("static bool match_n%d(Morphism *morphism, Edge *host_edge)\n",
        left_node->index);
    PTF("{\n");
-   if(type == 'i' || type == 'b') 
-        PTFI("Node *host_node = getTarget(host, host_edge);\n\n", 3);
-   else PTFI("Node *host_node = getSource(host, host_edge);\n\n", 3);
+   if(type == 'i' || type == 'b') PTFI("int host_index = host_edge->target;\n\n", 3);
+   else PTFI("int host_index = host_edge->source;\n\n", 3);
 
    string fail_code = (type == 'b') ? "candidate_node = false;" : "return false;";
    if(type == 'b') PTFI("bool candidate_node = true;\n", 3);
-   PTFI("if(host_node->matched) %s\n", 3, fail_code);
-   if(left_node->root) PTFI("if(!(host_node->root)) %s\n", 3, fail_code);
+   PTFI("if(nodeMatched(host, host_index)) %s\n", 3, fail_code);
+   if(left_node->root) PTFI("if(!nodeRoot(host, host_index)) %s\n", 3, fail_code);
    if(left_node->label.mark == ANY)
-      PTFI("if(host_node->label.mark == 0) %s\n", 3, fail_code);
-   else PTFI("if(host_node->label.mark != %d) %s\n", 3, left_node->label.mark, fail_code);
+      PTFI("if(nodeMark(host, host_index) == 0) %s\n", 3, fail_code);
+   else PTFI("if(nodeMark(host, host_index) != %d) %s\n", 3, left_node->label.mark, fail_code);
    emitDegreeCheck(left_node, 6);  
    PTF("%s;\n\n", fail_code);
 
@@ -422,19 +731,19 @@ static void emitNodeFromEdgeMatcher(Rule *rule, RuleNode *left_node, char type,
       PTFI("if(!candidate_node)\n", 3);
       PTFI("{\n", 3); 
       PTFI("/* Matching from bidirectional edge: check the second incident node. */\n", 6);
-      if(type == 'i' || type == 'b') 
-           PTFI("host_node = getSource(host, host_edge);\n", 6);
-      else PTFI("host_node = getTarget(host, host_edge);\n", 6);
-      PTFI("if(host_node->matched) return false;\n", 6);
-      if(left_node->root) PTFI("if(!(host_node->root)) return false;\n", 6);
+      if(type == 'i' || type == 'b') PTFI("host_index = host_edge->source;\n", 6);
+      else PTFI("host_index = host_edge->target;\n", 6);
+      PTFI("if(nodeMatched(host, host_index)) return false;\n", 6);
+      if(left_node->root) PTFI("if(!nodeRoot(host, host_index)) return false;\n", 6);
       if(left_node->label.mark == ANY)
-	 PTFI("if(host_node->label.mark == 0) return false;\n", 6);
-      else PTFI("if(host_node->label.mark != %d) return false;\n", 6, left_node->label.mark);
+	 PTFI("if(nodeMark(host, host_index) == 0) return false;\n", 6);
+      else PTFI("if(nodeMark(host, host_index) != %d) return false;\n", 6, left_node->label.mark);
       emitDegreeCheck(left_node, 6);  
       PTF("return false;\n\n");
       PTFI("}\n", 3);
    }
 
+   PTFI("Node *host_node = getNode(host, host_index);\n", 3);
    PTFI("HostLabel label = host_node->label;\n", 3);
    PTFI("bool match = false;\n", 3);
    if(hasListVariable(left_node->label))
@@ -456,9 +765,9 @@ static void emitNodeMatchResultCode(RuleNode *node, SearchOp *next_op, int inden
 {
    PTFI("if(match)\n", indent);
    PTFI("{\n", indent);
-   PTFI("addNodeMap(morphism, %d, host_node->index, new_assignments);\n",
+   PTFI("addNodeMap(morphism, %d, host_index, new_assignments);\n",
         indent + 3, node->index);
-   PTFI("host_node->matched = true;\n", indent + 3);
+   PTFI("setNodeMatched(host, host_index, true);\n", indent + 3);
    if(node->predicates != NULL)
    {
       PTFI("/* Update global booleans representing the node's predicates. */\n", indent + 3);
@@ -466,23 +775,11 @@ static void emitNodeMatchResultCode(RuleNode *node, SearchOp *next_op, int inden
       for(index = 0; index < node->predicate_count; index++)
          PTFI("evaluatePredicate%d(morphism);\n", indent + 3, 
               node->predicates[index]->bool_id);
-      if(next_op != NULL) PTFI("bool next_match_result = false;\n", indent + 3);
-      PTFI("if(evaluateCondition())", indent + 3);
-      if(next_op == NULL)
-      { 
-         PTF("\n");
-         PTFI("{\n", indent + 3);
-         PTFI("/* All items matched! */\n", indent + 6);
-         PTFI("return true;\n", indent + 6);
-         PTFI("}\n", indent + 3);
-      }
-      else
-      {
-         PTF(" next_match_result = ");
-         emitNextMatcherCall(next_op);
-         PTF(";\n");
-         PTFI("if(next_match_result) return true;\n", indent + 3);           
-      }
+      PTFI("bool next_match_result = false;\n", indent + 3);
+      PTFI("if(evaluateCondition()) next_match_result = ", indent + 3);
+      emitNextMatcherCall(next_op);
+      PTF(";\n");
+      PTFI("if(next_match_result) return true;\n", indent + 3);           
       PTFI("else\n", indent + 3);
       PTFI("{\n", indent + 3);  
       PTFI("/* Reset the boolean variables in the predicates of this node. */\n", 
@@ -494,27 +791,19 @@ static void emitNodeMatchResultCode(RuleNode *node, SearchOp *next_op, int inden
          else PTFI("b%d = true;\n", indent + 6, predicate->bool_id);
       }
       PTFI("removeNodeMap(morphism, %d);\n", indent + 6, node->index);
-      PTFI("host_node->matched = false;\n", indent + 6);  
+      PTFI("setNodeMatched(host, host_index, false);\n", indent + 6);  
       PTFI("}\n", indent + 3);
    }
    else
    {
-      if(next_op == NULL)
-      {
-         PTFI("/* All items matched! */\n", indent + 3);
-         PTFI("return true;\n", indent + 3);
-      }
-      else
-      {
-         PTFI("if(", indent + 3);
-         emitNextMatcherCall(next_op); 
-         PTF(") return true;\n");            
-         PTFI("else\n", indent + 3);
-         PTFI("{\n", indent + 3);  
-         PTFI("removeNodeMap(morphism, %d);\n", indent + 6, node->index);
-         PTFI("host_node->matched = false;\n", indent + 6);  
-         PTFI("}\n", indent + 3);
-      }
+      PTFI("if(", indent + 3);
+      emitNextMatcherCall(next_op); 
+      PTF(") return true;\n");            
+      PTFI("else\n", indent + 3);
+      PTFI("{\n", indent + 3);  
+      PTFI("removeNodeMap(morphism, %d);\n", indent + 6, node->index);
+      PTFI("setNodeMatched(host, host_index, false);\n", indent + 6);  
+      PTFI("}\n", indent + 3);
    }
    PTFI("}\n", indent);
    /* The else branch of the "if(match)" printed at the top of this function. */
@@ -526,23 +815,21 @@ static void emitNodeMatchResultCode(RuleNode *node, SearchOp *next_op, int inden
  * are obtained from the appropriate label class tables. */
 static void emitEdgeMatcher(Rule *rule, RuleEdge *left_edge, SearchOp *next_op)
 {
+   emitCandidateFunction(rule, NULL, left_edge, next_op);
    PTF("static bool match_e%d(Morphism *morphism)\n", left_edge->index);
    PTF("{\n");
-   PTFI("int host_index;\n", 3);
-   PTFI("for(host_index = 0; host_index < host->edges.size; host_index++)\n", 3);
-   PTFI("{\n", 3);
-   PTFI("Edge *host_edge = getEdge(host, host_index);\n", 6);
-   PTFI("if(host_edge == NULL || host_edge->index == -1) continue;\n", 6);
-   PTFI("if(host_edge->matched) continue;\n", 6);
-   if(left_edge->label.mark == ANY) 
-      PTFI("if(host_edge->label.mark == 0) continue;\n\n", 6);
-   else PTFI("if(host_edge->label.mark != %d) continue;\n\n", 6, left_edge->label.mark);
-   PTFI("HostLabel label = host_edge->label;\n", 6);
-   PTFI("bool match = false;\n", 6);
-   if(hasListVariable(left_edge->label))
-      generateVariableListMatchingCode(rule, left_edge->label, 6);
-   else generateFixedListMatchingCode(rule, left_edge->label, 6);
-   emitEdgeMatchResultCode(left_edge->index, next_op, 6);
+   int tables = emitLabelTables(left_edge->label);
+   emitFrontierScan('e', tables);
+   PTFI("if(edgeMatched(host, host_index)) continue;\n", 9);
+   PTFI("if(try_e%d(morphism, host_index)) return true;\n", 9, left_edge->index);
+   PTFI("}\n", 6);
+   PTFI("}\n", 3);
+   emitTableScan(tables, 'e');
+   PTFI("if(edgeMatched(host, host_index)) continue;\n", 9);
+   PTFI("resume_count = table_count;\n", 9);
+   PTFI("resume_index = table_index;\n", 9);
+   PTFI("if(try_e%d(morphism, host_index)) return true;\n", 9, left_edge->index);
+   PTFI("}\n", 6);
    PTFI("}\n", 3);
    PTFI("return false;\n", 3);
    PTF("}\n\n");
@@ -557,16 +844,16 @@ static void emitLoopEdgeMatcher(Rule *rule, RuleEdge *left_edge, SearchOp *next_
    PTFI("if(node_index < 0) return false;\n", 3);
    PTFI("Node *host_node = getNode(host, node_index);\n\n", 3);
 
-   PTFI("int counter;\n", 3);
-   PTFI("for(counter = 0; counter < host_node->out_edges.size + 2; counter++)\n", 3);
+   PTFI("int *host_edges = getOutEdges(host, host_node), counter;\n", 3);
+   PTFI("for(counter = 0; counter < nodeOutdegree(host, node_index); counter++)\n", 3);
    PTFI("{\n", 3);
-   PTFI("Edge *host_edge = getNthOutEdge(host, host_node, counter);\n", 6);
-   PTFI("if(host_edge == NULL) continue;\n", 6);
-   PTFI("if(host_edge->matched) continue;\n", 6);
-   PTFI("if(host_edge->source != host_edge->target) continue;\n", 6);
+   PTFI("int host_index = host_edges[counter];\n", 6);
+   PTFI("if(edgeMatched(host, host_index)) continue;\n", 6);
    if(left_edge->label.mark == ANY)
-      PTFI("if(host_edge->label.mark == 0) continue;\n\n", 6);
-   else PTFI("if(host_edge->label.mark != %d) continue;\n\n", 6, left_edge->label.mark);
+      PTFI("if(edgeMark(host, host_index) == 0) continue;\n", 6);
+   else PTFI("if(edgeMark(host, host_index) != %d) continue;\n", 6, left_edge->label.mark);
+   PTFI("Edge *host_edge = getEdge(host, host_index);\n", 6);
+   PTFI("if(host_edge->source != host_edge->target) continue;\n\n", 6);
    PTFI("HostLabel label = host_edge->label;\n", 6);
    PTFI("bool match = false;\n", 6);
    if(hasListVariable(left_edge->label))
@@ -581,85 +868,113 @@ static void emitLoopEdgeMatcher(Rule *rule, RuleEdge *left_edge, SearchOp *next_
  * nodes. Unlike matching a node from a matched incident edge, the LHS-node from
  * which this LHS-edge is matched may not necessarily be the previously matched 
  * node in the searchplan. The generated code uses the index of the incident nodes
- * of the LHS-edge to find the host node to which it has been matched. The candidate
- * host edges come from the edges lists of that node. 
+ * of the LHS-edge to find the host node to which it has been matched. If both
+ * incident nodes have been matched, the candidate host edges are the edges 
+ * between their images, which are drawn from the graph's edge index. Otherwise
+ * they come from the incident edges of the matched node.
  *
  * Called for various searchplan operations: matching an edge from its source,
- * matching an edge from its target, and matching bidirectional edges. In 
- * particular, the bidirectional edge code is generated by two calls to this
- * function. The skeleton of the generated code is largely the same for these 
- * operations, but different parts of the code printed by this function are required
- * for different operations. This is controlled by the three boolean flags:
+ * matching an edge from its target, and matching bidirectional edges. The flags
+ * control which host edges are candidates:
  *
  * source - When set, the generated code searches from the match of the source of 
  *          the rule edge. Otherwise, it searches from the match of the target.
- * initialise - When set, this prints the header of the generated matching function.
- *              This is set in all cases except for the second call in the generation
- *              of bidirectional edge matching code.
- * exit - When set, this prints the return statement of the generated matching function.
- *        This is set in all cases except for the first call in the generation of
- *        bidirectional edge matching code. */
+ * bidirectional - When set, the generated code searches all incident edges of the
+ *                 start node, in either direction. */
 static void emitEdgeFromNodeMatcher(Rule *rule, RuleEdge *left_edge, bool source,
-                                    bool initialise, bool exit, SearchOp *next_op)
+                                    bool bidirectional, SearchOp *next_op)
 {
    int start_index = source ? left_edge->source->index : left_edge->target->index;
    int end_index = source ? left_edge->target->index : left_edge->source->index;
-   string end_node_type = source ? "target" : "source";
 
-   if(initialise)
+   PTF("static bool match_e%d(Morphism *morphism)\n", left_edge->index);
+   PTF("{\n");
+   PTFI("/* Start node is the already-matched node from which the candidate\n", 3);
+   PTFI("   edges are drawn. End node may or may not have been matched already. */\n", 3);
+   PTFI("int start_index = lookupNode(morphism, %d);\n", 3, start_index);
+   PTFI("int end_index = lookupNode(morphism, %d);\n", 3, end_index);
+   PTFI("if(start_index < 0) return false;\n", 3);
+
+   /* Both end points are matched: the candidates are the edges between them. */
+   PTFI("if(end_index >= 0)\n", 3);
+   PTFI("{\n", 3);
+   PTFI("int host_index;\n", 6);
+   int direction;
+   for(direction = 0; direction < 2; direction++)
    {
-      PTF("static bool match_e%d(Morphism *morphism)\n", left_edge->index);
-      PTF("{\n");
-      PTFI("/* Start node is the already-matched node from which the candidate\n", 3);
-      PTFI("   edges are drawn. End node may or may not have been matched already. */\n", 3);
-      PTFI("int start_index = lookupNode(morphism, %d);\n", 3, start_index);
-      PTFI("int end_index = lookupNode(morphism, %d);\n", 3, end_index);
-      PTFI("if(start_index < 0) return false;\n", 3);
-      PTFI("Node *host_node = getNode(host, start_index);\n\n", 3);
-      PTFI("int counter;\n", 3);
+      /* The first pass draws edges in the direction of the rule edge. The second
+       * pass is only needed for bidirectional edges. */
+      bool forward = direction == 0;
+      if(!forward && !bidirectional) break;
+      PTFI("for(host_index = firstEdgeBetween(host, %s, %s); host_index >= 0;\n", 6,
+           source == forward ? "start_index" : "end_index",
+           source == forward ? "end_index" : "start_index");
+      PTFI("    host_index = nextEdgeBetween(host, host_index))\n", 6);
+      PTFI("{\n", 6);
+      emitEdgeFromNodeCandidateCode(rule, left_edge, false, source, bidirectional, next_op, 9);
+      PTFI("}\n", 6);
    }
-   if(source)
+   PTFI("return false;\n", 6);
+   PTFI("}\n\n", 3);
+
+   PTFI("Node *host_node = getNode(host, start_index);\n", 3);
+   if(bidirectional)
    {
-      PTFI("for(counter = 0; counter < host_node->out_edges.size + 2; counter++)\n", 3);
-      PTFI("{\n", 3);
-      PTFI("Edge *host_edge = getNthOutEdge(host, host_node, counter);\n", 6);
+      PTFI("int *host_edges = getIncidentEdges(host, host_node), counter;\n", 3);
+      PTFI("int degree = nodeIndegree(host, start_index) + "
+           "nodeOutdegree(host, start_index);\n", 3);
+      PTFI("for(counter = 0; counter < degree; counter++)\n", 3);
+   }
+   else if(source)
+   {
+      PTFI("int *host_edges = getOutEdges(host, host_node), counter;\n", 3);
+      PTFI("for(counter = 0; counter < nodeOutdegree(host, start_index); counter++)\n", 3);
    }
    else
    {
-      PTFI("for(counter = 0; counter < host_node->in_edges.size + 2; counter++)\n", 3);
-      PTFI("{\n", 3);
-      PTFI("Edge *host_edge = getNthInEdge(host, host_node, counter);\n", 6);
+      PTFI("int *host_edges = getInEdges(host, host_node), counter;\n", 3);
+      PTFI("for(counter = 0; counter < nodeIndegree(host, start_index); counter++)\n", 3);
    }
+   PTFI("{\n", 3);
+   PTFI("int host_index = host_edges[counter];\n", 6);
+   emitEdgeFromNodeCandidateCode(rule, left_edge, true, source, bidirectional, next_op, 6);
+   PTFI("}\n", 3);
+   PTFI("return false;\n}\n\n", 3);
+}
 
-   PTFI("if(host_edge == NULL) continue;\n", 6);
-   PTFI("if(host_edge->matched) continue;\n", 6);
-   PTFI("if(host_edge->source == host_edge->target) continue;\n", 6);
+/* Tests the host edge with index host_index against the rule edge and continues
+ * matching if it matches. The generated code runs in one of the loops of
+ * emitEdgeFromNodeMatcher, whose flags it takes. If incident is set, the
+ * candidate is an incident edge of the start node, and it is also checked that
+ * the edge is not a loop and that its other end node is unmatched. */
+static void emitEdgeFromNodeCandidateCode(Rule *rule, RuleEdge *left_edge, bool incident,
+                                          bool source, bool bidirectional, SearchOp *next_op,
+                                          int indent)
+{
+   PTFI("if(edgeMatched(host, host_index)) continue;\n", indent);
    if(left_edge->label.mark == ANY)
-      PTFI("if(host_edge->label.mark == 0) continue;\n\n", 6);
-   else PTFI("if(host_edge->label.mark != %d) continue;\n\n", 6, left_edge->label.mark);
-
-   PTFI("/* If the end node has been matched, check that the %s of the\n", 6, end_node_type);
-   PTFI(" * host edge is the image of the end node. */\n", 6);
-   PTFI("if(end_index >= 0)\n", 6);
-   PTFI("{\n", 6);
-   PTFI("if(host_edge->%s != end_index) continue;\n", 9, end_node_type);
-   PTFI("}\n", 6);
-   PTFI("/* Otherwise, the %s of the host edge should be unmatched. */\n", 6, end_node_type);
-   PTFI("else\n", 6);
-   PTFI("{\n", 6);
-   PTFI("Node *end_node = getNode(host, host_edge->%s);\n", 9, end_node_type);
-   PTFI("if(end_node->matched) continue;\n", 9);
-   PTFI("}\n\n", 6);
-
-   PTFI("HostLabel label = host_edge->label;\n", 6);
-   PTFI("bool match = false;\n", 6);
+      PTFI("if(edgeMark(host, host_index) == 0) continue;\n", indent);
+   else PTFI("if(edgeMark(host, host_index) != %d) continue;\n", indent, left_edge->label.mark);
+   PTFI("Edge *host_edge = getEdge(host, host_index);\n", indent);
+   if(incident)
+   {
+      PTFI("if(host_edge->source == host_edge->target) continue;\n", indent);
+      /* The end node is the other node incident to the host edge. In the 
+       * bidirectional case, the incoming edges of the start node precede its 
+       * outgoing edges. */
+      if(bidirectional)
+         PTFI("int end_node_index = counter < nodeIndegree(host, start_index) ? "
+              "host_edge->source : host_edge->target;\n", indent);
+      else PTFI("int end_node_index = host_edge->%s;\n", indent, source ? "target" : "source");
+      PTFI("if(nodeMatched(host, end_node_index)) continue;\n", indent);
+   }
+   PTF("\n");
+   PTFI("HostLabel label = host_edge->label;\n", indent);
+   PTFI("bool match = false;\n", indent);
    if(hasListVariable(left_edge->label))
-      generateVariableListMatchingCode(rule, left_edge->label, 6);
-   else generateFixedListMatchingCode(rule, left_edge->label, 6);
-   emitEdgeMatchResultCode(left_edge->index, next_op, 6);
-   PTFI("}\n", 3);
-
-   if(exit) PTFI("return false;\n}\n\n", 3);
+      generateVariableListMatchingCode(rule, left_edge->label, indent);
+   else generateFixedListMatchingCode(rule, left_edge->label, indent);
+   emitEdgeMatchResultCode(left_edge->index, next_op, indent);
 }
 
 /* Generates code to test the result of label matching a edge. If the label matching
@@ -669,30 +984,29 @@ static void emitEdgeMatchResultCode(int index, SearchOp *next_op, int indent)
 {
    PTFI("if(match)\n", indent);
    PTFI("{\n", indent);
-   PTFI("addEdgeMap(morphism, %d, host_edge->index, new_assignments);\n", indent + 3, index);
-   PTFI("host_edge->matched = true;\n", indent + 3);
-   if(next_op == NULL)
-   {
-      PTFI("/* All items matched! */\n", indent);
-      PTFI("return true;\n", indent);
-   }
-   else
-   {
-      PTFI("if(", indent + 3);
-      emitNextMatcherCall(next_op); 
-      PTF(") return true;\n");           
-      PTFI("else\n", indent + 3);
-      PTFI("{\n", indent + 3);                              
-      PTFI("removeEdgeMap(morphism, %d);\n", indent + 6, index);
-      PTFI("host_edge->matched = false;\n", indent + 6); 
-      PTFI("}\n", indent + 3);
-   } 
+   PTFI("addEdgeMap(morphism, %d, host_index, new_assignments);\n", indent + 3, index);
+   PTFI("setEdgeMatched(host, host_index, true);\n", indent + 3);
+   PTFI("if(", indent + 3);
+   emitNextMatcherCall(next_op); 
+   PTF(") return true;\n");           
+   PTFI("else\n", indent + 3);
+   PTFI("{\n", indent + 3);                              
+   PTFI("removeEdgeMap(morphism, %d);\n", indent + 6, index);
+   PTFI("setEdgeMatched(host, host_index, false);\n", indent + 6); 
+   PTFI("}\n", indent + 3);
    PTFI("}\n", indent);
    PTFI("else removeAssignments(morphism, new_assignments);\n", indent);
 }
 
+/* If there are no operations left, all items are matched, and the match is
+ * passed to reportMatch. */
 static void emitNextMatcherCall(SearchOp *next_operation)
 {
+   if(next_operation == NULL)
+   {
+      PTF("reportMatch(morphism)");
+      return;
+   }
    switch(next_operation->type)
    {
       case 'n':
@@ -725,6 +1039,7 @@ void generateRemoveLHSCode(string rule_name)
    fprintf(header, "void apply%s(Morphism *morphism, bool record_changes);\n", rule_name);
    PTF("void apply%s(Morphism *morphism, bool record_changes)\n", rule_name);
    PTF("{\n");
+   PTFI("clearFrontier(host);\n", 3);
 
    PTFI("int count;\n", 3);
    PTFI("for(count = 0; count < morphism->edges; count++)\n", 3);
@@ -733,8 +1048,8 @@ void generateRemoveLHSCode(string rule_name)
    PTFI("{\n", 6);
    PTFI("Edge *edge = getEdge(host, morphism->edge_map[count].host_index);\n", 9);
    PTFI("/* A hole is created if the edge is not at the right-most index of the array. */\n", 9);
-   PTFI("pushRemovedEdge(edge->label, edge->source, edge->target, edge->index,\n", 9);
-   PTFI("                edge->index < host->edges.size - 1);\n", 9);  
+   PTFI("pushRemovedEdge(edge->label, edge->source, edge->target, edge->out_position,\n", 9);
+   PTFI("                edge->in_position, edge->index, edge->index < host->edges.size - 1);\n", 9);  
    PTFI("}\n", 6);
    PTFI("removeEdge(host, morphism->edge_map[count].host_index);\n", 6);
    PTFI("}\n", 3);
@@ -745,7 +1060,7 @@ void generateRemoveLHSCode(string rule_name)
    PTFI("{\n", 6);
    PTFI("Node *node = getNode(host, morphism->node_map[count].host_index);\n", 9); 
    PTFI("/* A hole is created if the node is not at the right-most index of the array. */\n", 9);
-   PTFI("pushRemovedNode(node->root, node->label, node->index,\n", 9);
+   PTFI("pushRemovedNode(nodeRoot(host, node->index), node->label, node->index,\n", 9);
    PTFI("                node->index < host->nodes.size - 1);\n", 9);  
    PTFI("}\n", 6);
    PTFI("removeNode(host, morphism->node_map[count].host_index);\n", 6);
@@ -759,6 +1074,7 @@ void generateAddRHSCode(Rule *rule)
    fprintf(header, "void apply%s(bool record_changes);\n", rule->name);
    PTF("void apply%s(bool record_changes)\n", rule->name);
    PTF("{\n");
+   PTFI("clearFrontier(host);\n", 3);
    PTFI("int index;\n", 3);
    PTFI("HostLabel label;\n\n", 3);
    /* Generate code to retrieve the values assigned to the variables in the
@@ -834,6 +1150,7 @@ void generateApplicationCode(Rule *rule)
    fprintf(header, "void apply%s(Morphism *morphism, bool record_changes);\n", rule->name);
    PTF("void apply%s(Morphism *morphism, bool record_changes)\n", rule->name);
    PTF("{\n");
+   PTFI("clearFrontier(host);\n", 3);
    /* Generate code to retrieve the values assigned to the variables in the
     * matching phase. */
    int index;
@@ -891,8 +1208,8 @@ void generateApplicationCode(Rule *rule)
          PTFI("{\n", 3);
          PTFI("Edge *edge = getEdge(host, host_edge_index);\n", 6);
          PTFI("/* A hole is created if the edge is not at the right-most index of the array. */\n", 6);
-         PTFI("pushRemovedEdge(edge->label, edge->source, edge->target, edge->index,\n", 6);
-         PTFI("                edge->index < host->edges.size - 1);\n", 6);
+         PTFI("pushRemovedEdge(edge->label, edge->source, edge->target, edge->out_position,\n", 6);
+         PTFI("                edge->in_position, edge->index, edge->index < host->edges.size - 1);\n", 6);
          PTFI("}\n", 3);
          PTFI("removeEdge(host, host_edge_index);\n\n", 3);   
       }
@@ -958,7 +1275,7 @@ void generateApplicationCode(Rule *rule)
          PTFI("{\n", 3);
          PTFI("Node *node = getNode(host, host_node_index);\n", 6);
          PTFI("/* A hole is created if the node is not at the right-most index of the array. */\n", 6);
-         PTFI("pushRemovedNode(node->root, node->label, node->index,\n", 6);
+         PTFI("pushRemovedNode(nodeRoot(host, node->index), node->label, node->index,\n", 6);
          PTFI("                node->index < host->nodes.size - 1);\n", 6);  
          PTFI("}\n", 3);
          PTFI("removeNode(host, host_node_index);\n\n", 3);   
@@ -1030,8 +1347,7 @@ void generateApplicationCode(Rule *rule)
             /* Case (2) */
             if(!node->root && node->interface->root) 
             {
-               PTFI("Node *node%d = getNode(host, host_node_index);\n", 3, index);
-               PTFI("if(!node%d->root)\n", 3, index);
+               PTFI("if(!nodeRoot(host, host_node_index))\n", 3);
                PTFI("{\n", 3);
                PTFI("if(record_changes) pushChangedRootNode(host_node_index);\n", 6);
                PTFI("changeRoot(host, host_node_index);\n", 6);
@@ -440,6 +440,132 @@ bool hasListVariable(RuleLabel label)
    return false;
 }
 
+void getLabelClasses(RuleLabel label, bool *classes)
+{
+   int label_class;
+   for(label_class = 0; label_class < NUMBER_OF_CLASSES; label_class++)
+      classes[label_class] = false;
+   if(hasListVariable(label))
+   {
+      /* The list variable can match any sublist, so the host list must have at
+       * least as many atoms as the rest of the rule list. */
+      int min_length = label.length - 1;
+      classes[LONG_LIST_L] = true;
+      if(min_length <= 4) classes[LIST4_L] = true;
+      if(min_length <= 3) classes[LIST3_L] = true;
+      if(min_length <= 2) classes[LIST2_L] = true;
+      if(min_length <= 1) classes[INT_L] = classes[STRING_L] = true;
+      if(min_length == 0) classes[EMPTY_L] = true;
+      return;
+   }
+   switch(label.length)
+   {
+      case 0: classes[EMPTY_L] = true; break;
+      case 1:
+      {
+         RuleAtom *atom = label.list->first->atom;
+         if(atom->type == INTEGER_CONSTANT || atom->type == NEG) classes[INT_L] = true;
+         else if(atom->type == STRING_CONSTANT || atom->type == CONCAT) 
+            classes[STRING_L] = true;
+         else if(atom->type == VARIABLE && atom->variable.type == INTEGER_VAR)
+            classes[INT_L] = true;
+         else if(atom->type == VARIABLE && (atom->variable.type == CHARACTER_VAR ||
+                 atom->variable.type == STRING_VAR)) classes[STRING_L] = true;
+         else classes[INT_L] = classes[STRING_L] = true;
+         break;
+      }
+      case 2: classes[LIST2_L] = true; break;
+      case 3: classes[LIST3_L] = true; break;
+      case 4: classes[LIST4_L] = true; break;
+      default: classes[LONG_LIST_L] = true; break;
+   }
+}
+
+static bool atomUsesDegree(RuleAtom *atom)
+{
+   switch(atom->type)
+   {
+      case INDEGREE:
+      case OUTDEGREE:
+           return true;
+
+      case NEG:
+           return atomUsesDegree(atom->neg_exp);
+
+      case ADD:
+      case SUBTRACT:
+      case MULTIPLY:
+      case DIVIDE:
+      case CONCAT:
+           return atomUsesDegree(atom->bin_op.left_exp) ||
+                  atomUsesDegree(atom->bin_op.right_exp);
+
+      default:
+           return false;
+   }
+}
+
+static bool labelUsesDegree(RuleLabel label)
+{
+   if(label.list == NULL) return false;
+   RuleListItem *item;
+   for(item = label.list->first; item != NULL; item = item->next)
+      if(atomUsesDegree(item->atom)) return true;
+   return false;
+}
+
+static bool conditionUsesEdges(Condition *condition)
+{
+   if(condition == NULL) return false;
+   switch(condition->type)
+   {
+      case 'e':
+      {
+           Predicate *predicate = condition->predicate;
+           switch(predicate->type)
+           {
+              case EDGE_PRED:
+                   return true;
+
+              case EQUAL:
+              case NOT_EQUAL:
+                   return labelUsesDegree(predicate->list_comp.left_label) ||
+                          labelUsesDegree(predicate->list_comp.right_label);
+
+              case GREATER:
+              case GREATER_EQUAL:
+              case LESS:
+              case LESS_EQUAL:
+                   return atomUsesDegree(predicate->atom_comp.left_atom) ||
+                          atomUsesDegree(predicate->atom_comp.right_atom);
+
+              default:
+                   return false;
+           }
+      }
+      case 'n':
+           return conditionUsesEdges(condition->neg_condition);
+
+      case 'o':
+      case 'a':
+           return conditionUsesEdges(condition->left_condition) ||
+                  conditionUsesEdges(condition->right_condition);
+
+      default:
+           print_to_log("Error (conditionUsesEdges): Unexpected condition type %c.\n",
+                        condition->type);
+           return true;
+   }
+}
+
+bool matchDependsOnAllEdges(Rule *rule)
+{
+   int index;
+   for(index = 0; index < rule->lhs->node_index; index++)
+      if(getRuleNode(rule->lhs, index)->interface == NULL) return true;
+   return conditionUsesEdges(rule->condition);
+}
+
 static void printOperation(RuleAtom *left_exp, RuleAtom *right_exp, 
                            string const operation, bool nested, FILE *file);
 
@@ -257,6 +257,14 @@ RuleList *appendRuleAtom(RuleList *list, RuleAtom *atom);
 bool equalRuleLists(RuleLabel left_label, RuleLabel right_label);
 /* Used to determine the appropriate function call to generate label matching code. */
 bool hasListVariable(RuleLabel label);
+/* Sets classes[c] to true if a host label of class c can match the LHS label
+ * and to false otherwise. The array must have NUMBER_OF_CLASSES elements. */
+void getLabelClasses(RuleLabel label, bool *classes);
+/* Checks if the existence of a match of the rule can depend on host edges that
+ * are not images of LHS edges. This is the case if the rule deletes a node,
+ * whose image must satisfy the dangling condition, or if the rule condition
+ * contains an edge predicate or a degree operator. */
+bool matchDependsOnAllEdges(Rule *rule);
 
 void printRule(Rule *rule, FILE *file);
 void freeRule(Rule *rule);
@@ -17,6 +17,11 @@
 
 static void traverseNode(Searchplan *searchplan, RuleNode *node, char type, 
                          bool *tagged_nodes, bool *tagged_edges);
+static void traverseIncidentEdges(Searchplan *searchplan, RuleNode *node,
+                                  bool *tagged_nodes, bool *tagged_edges);
+static RuleEdge *selectiveEdge(RuleNode *node);
+static void traverseFromEdge(Searchplan *searchplan, RuleEdge *edge, 
+                             bool *tagged_nodes, bool *tagged_edges);
 static void traverseEdge(Searchplan *searchplan, RuleEdge *node, char type, 
                          bool *tagged_nodes, bool *tagged_edges);
 
@@ -85,7 +90,9 @@ Searchplan *generateSearchplan(RuleGraph *lhs)
       if(!tagged_nodes[index]) 
       {
          RuleNode *node = getRuleNode(lhs, index);
-         traverseNode(searchplan, node, 'n', tagged_nodes, tagged_edges);
+         RuleEdge *edge = selectiveEdge(node);
+         if(edge != NULL) traverseFromEdge(searchplan, edge, tagged_nodes, tagged_edges);
+         else traverseNode(searchplan, node, 'n', tagged_nodes, tagged_edges);
       }
    }
    return searchplan;
@@ -96,6 +103,12 @@ static void traverseNode(Searchplan *searchplan, RuleNode *node, char type,
 {
    tagged_nodes[node->index] = true;
    appendSearchOp(searchplan, type, node->index);
+   traverseIncidentEdges(searchplan, node, tagged_nodes, tagged_edges);
+}
+
+static void traverseIncidentEdges(Searchplan *searchplan, RuleNode *node,
+                                  bool *tagged_nodes, bool *tagged_edges)
+{
    /* Search the node's incident edges for an untagged edge. Outedges
     * are arbitrarily examined first. If no such edges exist, the function
     * exits and control passes to the caller. */
@@ -158,6 +171,72 @@ static void traverseEdge(Searchplan *searchplan, RuleEdge *edge, char type,
    }
 }
 
+/* A rough measure of how few host items a label matches. Host items with a
+ * non-default mark are assumed to be rarer than items with a constant atom in
+ * their list. */
+static int selectivity(RuleLabel label)
+{
+   int score = 0;
+   if(label.mark != NONE && label.mark != ANY) score += 2;
+   if(label.list == NULL) return score;
+   RuleListItem *item = label.list->first;
+   while(item != NULL)
+   {
+      if(item->atom->type == INTEGER_CONSTANT || item->atom->type == STRING_CONSTANT)
+      {
+         score++;
+         break;
+      }
+      item = item->next;
+   }
+   return score;
+}
+
+/* Returns the incident edge of an untagged node with the most selective label
+ * if that label is more selective than the node's own label. Loops and
+ * bidirectional edges are not considered. Returns NULL if no such edge exists. */
+static RuleEdge *selectiveEdge(RuleNode *node)
+{
+   RuleEdge *best_edge = NULL;
+   int best_score = selectivity(node->label);
+   RuleEdges *iterator = node->outedges;
+   bool outedges = true;
+   while(iterator != NULL)
+   {
+      RuleEdge *edge = iterator->edge;
+      if(edge->source != edge->target && !edge->bidirectional &&
+         selectivity(edge->label) > best_score)
+      {
+         best_edge = edge;
+         best_score = selectivity(edge->label);
+      }
+      iterator = iterator->next;
+      if(iterator == NULL && outedges)
+      {
+         iterator = node->inedges;
+         outedges = false;
+      }
+   }
+   return best_edge;
+}
+
+/* Starts the traversal of a connected component at an edge. Both incident nodes
+ * are matched from the edge before the traversal continues from them, because
+ * the generated matchers for 'o' and 'i' operations take the host edge matched
+ * by the preceding operation. */
+static void traverseFromEdge(Searchplan *searchplan, RuleEdge *edge, 
+                             bool *tagged_nodes, bool *tagged_edges)
+{
+   tagged_edges[edge->index] = true;
+   appendSearchOp(searchplan, 'e', edge->index);
+   tagged_nodes[edge->source->index] = true;
+   appendSearchOp(searchplan, 'o', edge->source->index);
+   tagged_nodes[edge->target->index] = true;
+   appendSearchOp(searchplan, 'i', edge->target->index);
+   traverseIncidentEdges(searchplan, edge->source, tagged_nodes, tagged_edges);
+   traverseIncidentEdges(searchplan, edge->target, tagged_nodes, tagged_edges);
+}
+
 void printSearchplan(Searchplan *plan)
 { 
    if(plan->first == NULL) printf("Empty searchplan.\n");
@@ -71,8 +71,11 @@ typedef struct Searchplan {
  *     outgoing edge of a root node, add the 's' operation to the searchplan.
  *     Once this step is complete, all connected components containing root
  *     nodes have been examined.
- * (2) Scan the node list of the graph, performing step 2 on any untagged nodes.
- *     Unnecessary if the input graph is root-connected.
+ * (2) Scan the node list of the graph, performing step 1 on any untagged nodes.
+ *     Unnecessary if the input graph is root-connected. If an incident edge of
+ *     the untagged node has a more selective label than the node (for example,
+ *     a constant list or a mark), the traversal starts from that edge instead,
+ *     since edge candidates are drawn from the host graph's label class tables.
  *
  * The depth-first search is performed by recursive calls to traverseNode and
  * traverseEdge. These two functions are responsible for checking if items